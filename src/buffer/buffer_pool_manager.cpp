@@ -1,30 +1,67 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances,
+                                     ReplacerType replacer_type)
     : pool_size_(pool_size), disk_manager_(disk_manager) {
+  ASSERT(num_instances > 0 && num_instances <= pool_size, "Invalid number of buffer pool instances.");
   pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    free_list_.emplace_back(i);
+  // spread the frames as evenly as possible, the first (pool_size % num_instances) instances get one more
+  size_t offset = 0;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *instance = new BufferPoolInstance();
+    instance->pool_size_ = pool_size_ / num_instances + (i < pool_size_ % num_instances ? 1 : 0);
+    instance->pages_ = pages_ + offset;
+    switch (replacer_type) {
+      case ReplacerType::kLRUK:
+        instance->replacer_ = new LRUKReplacer(instance->pool_size_);
+        break;
+      case ReplacerType::kClock:
+        instance->replacer_ = new CLOCKReplacer(instance->pool_size_);
+        break;
+      default:
+        instance->replacer_ = new LRUReplacer(instance->pool_size_);
+    }
+    for (size_t j = 0; j < instance->pool_size_; j++) {
+      instance->free_list_.emplace_back(j);
+    }
+    offset += instance->pool_size_;
+    instances_.push_back(instance);
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    FlushPage(page.first);
+  StopPageCleaner();
+  if (prefetcher_.joinable()) {
+    {
+      std::scoped_lock<std::mutex> lock(prefetch_latch_);
+      prefetch_stop_ = true;
+    }
+    prefetch_cv_.notify_one();
+    prefetcher_.join();
+  }
+  for (auto instance : instances_) {
+    std::vector<std::pair<page_id_t, Page *>> dirty_pages;
+    for (auto page : instance->page_table_) {
+      if (instance->pages_[page.second].is_dirty_) {
+        dirty_pages.emplace_back(page.first, &instance->pages_[page.second]);
+      }
+    }
+    std::sort(dirty_pages.begin(), dirty_pages.end());
+    FlushFrames(dirty_pages);
+    delete instance->replacer_;
+    delete instance;
   }
   delete[] pages_;
-  delete replacer_;
 }
 
-/**
- * TODO: Student Implement
- */
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
@@ -33,153 +70,511 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-	Page* p = nullptr;
-	frame_id_t frame_id = -1;
-	if (page_table_.find(page_id) != page_table_.end()) {
-		frame_id = page_table_[page_id];
-		p = &pages_[frame_id];
-		//replacer_->Pin(frame_id);
-		p->pin_count_++;
-		//return p;
-	} else {
-		if (!free_list_.empty()) {
-			frame_id = free_list_.front();
-			free_list_.pop_front();
-		} else {
-			bool pick_success = replacer_->Victim(&frame_id);
-			if (!pick_success) {
-				return nullptr;
-			}
-		}
-		p = &pages_[frame_id];
-		if (p->IsDirty()) {
-			FlushPage(p->page_id_);
-		}
-		page_table_.erase(p->page_id_);
-		page_table_.emplace(page_id, frame_id);
-
-		p->page_id_ = page_id;
-		p->pin_count_ = 0; // or 1?
-		p->is_dirty_ = false; // or false?
-
-		disk_manager_->ReadPage(page_id, p->data_);
-	}
-
-	return p;
-}
-
-/**
- * TODO: Student Implement
- */
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  auto &instance = GetInstance(page_id);
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  auto iter = instance.page_table_.find(page_id);
+  if (iter != instance.page_table_.end()) {
+    Page *p = &instance.pages_[iter->second];
+    // every fetch is a reference, history based replacers need to see it even if the page is already pinned
+    p->pin_count_++;
+    p->prefetched_ = false;
+    instance.replacer_->Pin(iter->second);
+    return p;
+  }
+  frame_id_t frame_id = TryToFindFreePage(instance);
+  if (frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+  Page *p = &instance.pages_[frame_id];
+  instance.page_table_.emplace(page_id, frame_id);
+  p->page_id_ = page_id;
+  p->pin_count_ = 1;
+  p->is_dirty_ = false;
+  p->prefetched_ = false;
+  instance.replacer_->Pin(frame_id);
+  // a read-ahead of this page still in flight is of no use anymore
+  instance.prefetching_.erase(page_id);
+  disk_manager_->ReadPage(page_id, p->data_);
+  return p;
+}
+
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferRing *ring) {
+  if (ring == nullptr || page_id == INVALID_PAGE_ID) {
+    return FetchPage(page_id);
+  }
+  {
+    // cached pages belong to the general pool, the ring only recycles what it read itself (or read ahead for it)
+    auto &instance = GetInstance(page_id);
+    std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+    auto iter = instance.page_table_.find(page_id);
+    if (iter != instance.page_table_.end() && !instance.pages_[iter->second].prefetched_) {
+      return FetchPage(page_id);
+    }
+  }
+  page_id_t &slot = ring->slots_[ring->next_slot_];
+  ring->next_slot_ = (ring->next_slot_ + 1) % ring->slots_.size();
+  if (slot != INVALID_PAGE_ID) {
+    // fails harmlessly if someone else still holds the old page
+    EvictPage(slot);
+  }
+  slot = page_id;
+  return FetchPage(page_id);
+}
+
+Page *BufferPoolManager::NewPage(page_id_t &page_id, page_id_t near_page_id) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-	if (free_list_.empty() && replacer_->Size() == 0) {
-		return nullptr;
-	} else {
-		frame_id_t frame_id = -1;
-		page_id = disk_manager_->AllocatePage();
-		if (!free_list_.empty()) { // pick from free list
-			frame_id = free_list_.front();
-			free_list_.pop_front();
-		} else { // pick from replacer
-			bool pick_success = replacer_->Victim(&frame_id);
-			if (!pick_success) {
-				return nullptr;
-			}
-		}
-		Page* p = &pages_[frame_id];
-		if (p->IsDirty()) {
-			FlushPage(p->page_id_);
-		}
-		page_table_.erase(p->page_id_);
-		page_table_.emplace(page_id, frame_id);
-		p->ResetMemory();
-		p->page_id_ = page_id;
-		p->pin_count_ = 0; // or 1?
-		p->is_dirty_ = false; // or false?
-
-		return p;
-	}
-
-}
-
-/**
- * TODO: Student Implement
- */
+  page_id_t new_page_id = AllocatePage(near_page_id);
+  if (new_page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  auto &instance = GetInstance(new_page_id);
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  if (instance.page_table_.find(new_page_id) != instance.page_table_.end()) {
+    // read-ahead raced with the deallocation of this page id and cached the dead page
+    EvictPage(new_page_id);
+  }
+  frame_id_t frame_id = TryToFindFreePage(instance);
+  if (frame_id == INVALID_FRAME_ID) {
+    // the instance owning this page id is fully pinned, give the page back
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  Page *p = &instance.pages_[frame_id];
+  instance.page_table_.emplace(new_page_id, frame_id);
+  p->ResetMemory();
+  p->page_id_ = new_page_id;
+  p->pin_count_ = 1;
+  p->is_dirty_ = false;
+  p->prefetched_ = false;
+  instance.replacer_->Pin(frame_id);
+  page_id = new_page_id;
+  return p;
+}
+
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-	bool flag = false;
-	if (page_table_.find(page_id) == page_table_.end()) {
-		flag = true; // not exist
-	} else {
-		frame_id_t frame_id = page_table_[page_id];
-		Page* p = &pages_[frame_id];
-		if (p->pin_count_ == 0) {
-			disk_manager_->DeAllocatePage(page_id);
-			page_table_.erase(page_id);
-			free_list_.emplace_back(frame_id);
-			// free_list_.push_back(frame_id);
-			//p->ResetMemory();
-			p->page_id_ = INVALID_PAGE_ID;
-			p->is_dirty_ = false;
-			flag = true;
-		} else {
-			flag = false; // non-zero pin-count; not need
-		}		
-	}
-
-	return flag;
-}
-
-/**
- * TODO: Student Implement
- */
+  auto &instance = GetInstance(page_id);
+  while (true) {
+    uint64_t releases;
+    {
+      // read before looking at the page, so a background unpin after the look is not missed
+      std::scoped_lock<std::mutex> background_lock(instance.background_latch_);
+      releases = instance.background_releases_;
+    }
+    {
+      std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+      auto iter = instance.page_table_.find(page_id);
+      if (iter == instance.page_table_.end()) {
+        break;
+      }
+      frame_id_t frame_id = iter->second;
+      Page *p = &instance.pages_[frame_id];
+      if (p->pin_count_ > p->background_pins_) {
+        return false;
+      }
+      if (p->background_pins_ == 0) {
+        instance.replacer_->Remove(frame_id);
+        instance.page_table_.erase(iter);
+        instance.free_list_.emplace_back(frame_id);
+        p->page_id_ = INVALID_PAGE_ID;
+        p->is_dirty_ = false;
+        break;
+      }
+    }
+    // the page cleaner or read-ahead holds the page for a moment, wait for it to let go
+    std::unique_lock<std::mutex> background_lock(instance.background_latch_);
+    instance.background_cv_.wait(background_lock,
+                                 [&instance, releases]() { return instance.background_releases_ != releases; });
+  }
+  DeallocatePage(page_id);
+  return true;
+}
+
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-	bool flag = false;
-	if (page_table_.find(page_id) != page_table_.end()) {
-		frame_id_t frame_id = page_table_[page_id];
-		Page* p = &pages_[frame_id];
-		p->pin_count_ = 0; // unpin
-		if (is_dirty) {
-			p->is_dirty_ = true;
-		}
-		replacer_->Unpin(frame_id);
-		flag = true;
-	} 
-	// else {
-	// 	flag = false;
-	// }
-	return flag;
-}
-
-/**
- * TODO: Student Implement
- */
+  auto &instance = GetInstance(page_id);
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  auto iter = instance.page_table_.find(page_id);
+  if (iter == instance.page_table_.end()) {
+    return false;
+  }
+  Page *p = &instance.pages_[iter->second];
+  if (p->pin_count_ <= 0) {
+    return false;
+  }
+  if (is_dirty) {
+    p->is_dirty_ = true;
+    p->dirty_version_++;
+  }
+  if (--p->pin_count_ == 0) {
+    instance.replacer_->Unpin(iter->second);
+  }
+  return true;
+}
+
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-	bool flag = false;
-	if (page_table_.find(page_id) != page_table_.end()) {
-		frame_id_t frame_id = page_table_[page_id];
-		Page* p = &pages_[frame_id];
-		if (p->is_dirty_) { // only dirty page needs flush
-			disk_manager_->WritePage(page_id, p->data_);
-			p->is_dirty_ = false;
-		}
-		flag = true;
-	}
-
-	return flag;
-}
-
-page_id_t BufferPoolManager::AllocatePage() {
-  int next_page_id = disk_manager_->AllocatePage();
+  auto &instance = GetInstance(page_id);
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  auto iter = instance.page_table_.find(page_id);
+  if (iter == instance.page_table_.end()) {
+    return false;
+  }
+  FlushFrame(&instance.pages_[iter->second]);
+  return true;
+}
+
+frame_id_t BufferPoolManager::TryToFindFreePage(BufferPoolInstance &instance) {
+  frame_id_t frame_id = INVALID_FRAME_ID;
+  if (!instance.free_list_.empty()) {
+    frame_id = instance.free_list_.front();
+    instance.free_list_.pop_front();
+    return frame_id;
+  }
+  if (!instance.replacer_->Victim(&frame_id)) {
+    return INVALID_FRAME_ID;
+  }
+  Page *victim = &instance.pages_[frame_id];
+  if (victim->is_dirty_) {
+    // the page cleaner fell behind, write on the caller's path and let the cleaner know
+    foreground_writes_++;
+    FlushFrame(victim);
+    std::scoped_lock<std::mutex> cleaner_lock(page_cleaner_latch_);
+    page_cleaner_wakeup_ = true;
+    page_cleaner_cv_.notify_one();
+  }
+  instance.page_table_.erase(victim->page_id_);
+  return frame_id;
+}
+
+bool BufferPoolManager::EvictPage(page_id_t page_id) {
+  auto &instance = GetInstance(page_id);
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  auto iter = instance.page_table_.find(page_id);
+  if (iter == instance.page_table_.end()) {
+    return false;
+  }
+  frame_id_t frame_id = iter->second;
+  Page *p = &instance.pages_[frame_id];
+  if (p->pin_count_ > 0) {
+    return false;
+  }
+  FlushFrame(p);
+  instance.replacer_->Remove(frame_id);
+  instance.page_table_.erase(iter);
+  instance.free_list_.emplace_back(frame_id);
+  p->page_id_ = INVALID_PAGE_ID;
+  return true;
+}
+
+void BufferPoolManager::FlushFrame(Page *page) {
+  // a write of the page cleaner still in flight could land after ours and put an older copy on disk
+  auto &instance = GetInstance(page->page_id_);
+  {
+    std::unique_lock<std::mutex> background_lock(instance.background_latch_);
+    instance.background_cv_.wait(background_lock, [page]() { return !page->writing_; });
+  }
+  // only dirty page needs flush
+  if (page->is_dirty_) {
+    instance.prefetching_.erase(page->page_id_);
+    disk_manager_->WritePage(page->page_id_, page->data_);
+    page->is_dirty_ = false;
+  }
+}
+
+void BufferPoolManager::PrefetchPage(page_id_t page_id, size_t depth, NextPageFunc next_page) {
+  if (page_id == INVALID_PAGE_ID || depth == 0) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(prefetch_latch_);
+  if (prefetch_queue_.size() >= MAX_PREFETCH_QUEUE_SIZE) {
+    return;
+  }
+  if (!prefetcher_.joinable()) {
+    prefetcher_ = std::thread(&BufferPoolManager::PrefetchLoop, this);
+  }
+  bool registered = false;
+  {
+    // register the page now, so that the read-ahead notices when the caller fetches it before the request is served
+    auto &instance = GetInstance(page_id);
+    std::scoped_lock<std::recursive_mutex> instance_lock(instance.latch_);
+    if (instance.page_table_.find(page_id) == instance.page_table_.end()) {
+      registered = instance.prefetching_.insert(page_id).second;
+    }
+  }
+  prefetch_queue_.push_back({page_id, depth, next_page, registered});
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchLoop() {
+  while (true) {
+    std::vector<PrefetchRequest> chains;
+    {
+      std::unique_lock<std::mutex> lock(prefetch_latch_);
+      prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+      if (prefetch_stop_) {
+        return;
+      }
+      chains.assign(prefetch_queue_.begin(), prefetch_queue_.end());
+      prefetch_queue_.clear();
+    }
+    // every round reads the next uncached page of every pending chain in one batch
+    while (!chains.empty()) {
+      std::vector<PrefetchRequest> pending;
+      for (auto &chain : chains) {
+        // walking over cached pages costs no I/O
+        while (chain.depth_ > 0 && chain.page_id_ != INVALID_PAGE_ID) {
+          page_id_t next_page_id;
+          if (PrefetchLookup(chain.page_id_, chain.next_page_, chain.registered_, &next_page_id)) {
+            chain.registered_ = false;
+            pending.push_back(chain);
+            break;
+          }
+          chain.registered_ = false;
+          chain.page_id_ = next_page_id;
+          chain.depth_--;
+        }
+      }
+      if (pending.empty()) {
+        break;
+      }
+      // read without holding any latch, foreground fetches keep going meanwhile
+      std::vector<char> data(pending.size() * PAGE_SIZE);
+      std::vector<PageIORequest> reads;
+      for (size_t i = 0; i < pending.size(); i++) {
+        reads.push_back({pending[i].page_id_, data.data() + i * PAGE_SIZE, false, nullptr});
+      }
+      disk_manager_->ExecuteBatch(reads);
+      for (size_t i = 0; i < pending.size(); i++) {
+        pending[i].page_id_ = PrefetchInstall(pending[i].page_id_, data.data() + i * PAGE_SIZE, pending[i].next_page_);
+        pending[i].depth_--;
+      }
+      chains = std::move(pending);
+    }
+  }
+}
+
+bool BufferPoolManager::PrefetchLookup(page_id_t page_id, NextPageFunc next_page, bool registered,
+                                       page_id_t *next_page_id) {
+  *next_page_id = INVALID_PAGE_ID;
+  Page *cached = nullptr;
+  {
+    auto &instance = GetInstance(page_id);
+    std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+    auto iter = instance.page_table_.find(page_id);
+    if (iter == instance.page_table_.end()) {
+      if (registered && instance.prefetching_.erase(page_id) == 0) {
+        // fetched and dropped again since it was queued, reading it once more would only pollute the pool
+        return false;
+      }
+      if (disk_manager_->IsPageFree(page_id)) {
+        return false;
+      }
+      instance.prefetching_.insert(page_id);
+      return true;
+    }
+    if (registered) {
+      instance.prefetching_.erase(page_id);
+    }
+    if (next_page == nullptr) {
+      return false;
+    }
+    cached = &instance.pages_[iter->second];
+    PinBackground(instance, iter->second);
+  }
+  *next_page_id = ReadNextPageId(cached, next_page);
+  return false;
+}
+
+page_id_t BufferPoolManager::PrefetchInstall(page_id_t page_id, const char *data, NextPageFunc next_page) {
+  Page *cached = nullptr;
+  {
+    auto &instance = GetInstance(page_id);
+    std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+    bool superseded = instance.prefetching_.erase(page_id) == 0;
+    auto iter = instance.page_table_.find(page_id);
+    if (iter != instance.page_table_.end()) {
+      if (next_page == nullptr) {
+        return INVALID_PAGE_ID;
+      }
+      cached = &instance.pages_[iter->second];
+      PinBackground(instance, iter->second);
+    } else {
+      if (superseded) {
+        // a fetch read the page while we were reading it, and it may have been modified, written back or evicted by a
+        // BufferRing since. Our copy is stale or unwanted.
+        return INVALID_PAGE_ID;
+      }
+      frame_id_t frame_id = TryToFindFreePage(instance);
+      if (frame_id == INVALID_FRAME_ID) {
+        return INVALID_PAGE_ID;
+      }
+      Page *p = &instance.pages_[frame_id];
+      memcpy(p->data_, data, PAGE_SIZE);
+      p->page_id_ = page_id;
+      p->pin_count_ = 0;
+      p->is_dirty_ = false;
+      p->prefetched_ = true;
+      // nobody can reach the frame before it is in the page table, read the link now
+      page_id_t next_page_id = next_page == nullptr ? INVALID_PAGE_ID : next_page(p);
+      instance.page_table_.emplace(page_id, frame_id);
+      instance.replacer_->Unpin(frame_id);
+      prefetch_reads_++;
+      return next_page_id;
+    }
+  }
+  return ReadNextPageId(cached, next_page);
+}
+
+void BufferPoolManager::PinBackground(BufferPoolInstance &instance, frame_id_t frame_id) {
+  Page *p = &instance.pages_[frame_id];
+  p->background_pins_++;
+  if (p->pin_count_++ == 0) {
+    instance.replacer_->Pin(frame_id);
+  }
+}
+
+void BufferPoolManager::UnpinBackground(Page *page) {
+  auto &instance = GetInstance(page->page_id_);
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  page->background_pins_--;
+  UnpinPage(page->page_id_, false);
+  std::scoped_lock<std::mutex> background_lock(instance.background_latch_);
+  instance.background_releases_++;
+  instance.background_cv_.notify_all();
+}
+
+page_id_t BufferPoolManager::ReadNextPageId(Page *page, NextPageFunc next_page) {
+  // the page may be changed by its user, read the link under its latch and without holding the instance latch
+  page->RLatch();
+  page_id_t next_page_id = next_page(page);
+  page->RUnlatch();
+  UnpinBackground(page);
+  return next_page_id;
+}
+
+void BufferPoolManager::StartPageCleaner(double clean_target, uint32_t interval_ms) {
+  if (page_cleaner_.joinable()) {
+    return;
+  }
+  page_cleaner_stop_ = false;
+  page_cleaner_ = std::thread(&BufferPoolManager::PageCleanerLoop, this, clean_target, interval_ms);
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  if (!page_cleaner_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(page_cleaner_latch_);
+    page_cleaner_stop_ = true;
+  }
+  page_cleaner_cv_.notify_one();
+  page_cleaner_.join();
+}
+
+void BufferPoolManager::PageCleanerLoop(double clean_target, uint32_t interval_ms) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(page_cleaner_latch_);
+      page_cleaner_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                                [this] { return page_cleaner_stop_ || page_cleaner_wakeup_; });
+      if (page_cleaner_stop_) {
+        return;
+      }
+      page_cleaner_wakeup_ = false;
+    }
+    for (auto instance : instances_) {
+      background_writes_ += CleanInstance(*instance, clean_target);
+    }
+    // doubles as the checkpoint of the disk manager's cached allocation state
+    disk_manager_->FlushMetaData();
+  }
+}
+
+size_t BufferPoolManager::CleanInstance(BufferPoolInstance &instance, double clean_target) {
+  size_t target = static_cast<size_t>(clean_target * instance.pool_size_);
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_frames;
+  std::vector<uint32_t> versions;
+  std::vector<char> data;
+  {
+    std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+    size_t clean = instance.free_list_.size();
+    for (auto &entry : instance.page_table_) {
+      Page *p = &instance.pages_[entry.second];
+      if (p->pin_count_ > 0) {
+        continue;
+      }
+      if (p->is_dirty_) {
+        dirty_frames.emplace_back(entry);
+      } else {
+        clean++;
+      }
+    }
+    if (clean >= target) {
+      return 0;
+    }
+    // write in page id order so the disk sees mostly sequential writes
+    std::sort(dirty_frames.begin(), dirty_frames.end());
+    dirty_frames.resize(std::min(dirty_frames.size(), target - clean));
+    // take a copy of each page while nobody has it pinned, and pin it so it stays in its frame until written
+    data.resize(dirty_frames.size() * PAGE_SIZE);
+    for (size_t i = 0; i < dirty_frames.size(); i++) {
+      Page *p = &instance.pages_[dirty_frames[i].second];
+      PinBackground(instance, dirty_frames[i].second);
+      p->writing_ = true;
+      versions.push_back(p->dirty_version_);
+      memcpy(data.data() + i * PAGE_SIZE, p->data_, PAGE_SIZE);
+      instance.prefetching_.erase(dirty_frames[i].first);
+    }
+  }
+  // the writes run without the instance latch, foreground fetches and unpins keep going meanwhile
+  std::vector<PageIORequest> writes;
+  for (size_t i = 0; i < dirty_frames.size(); i++) {
+    writes.push_back({dirty_frames[i].first, data.data() + i * PAGE_SIZE, true, nullptr});
+  }
+  disk_manager_->ExecuteBatch(writes);
+  // cleared before taking the latch, FlushFrame may be waiting on it with the latch held
+  {
+    std::scoped_lock<std::mutex> background_lock(instance.background_latch_);
+    for (auto &entry : dirty_frames) {
+      instance.pages_[entry.second].writing_ = false;
+    }
+    instance.background_cv_.notify_all();
+  }
+  std::scoped_lock<std::recursive_mutex> lock(instance.latch_);
+  for (size_t i = 0; i < dirty_frames.size(); i++) {
+    Page *p = &instance.pages_[dirty_frames[i].second];
+    // a page dirtied again after the copy was taken still has to be written
+    if (p->dirty_version_ == versions[i]) {
+      p->is_dirty_ = false;
+    }
+    UnpinBackground(p);
+  }
+  return dirty_frames.size();
+}
+
+void BufferPoolManager::FlushFrames(const std::vector<std::pair<page_id_t, Page *>> &pages) {
+  std::vector<PageIORequest> writes;
+  for (auto &entry : pages) {
+    Page *p = entry.second;
+    GetInstance(p->page_id_).prefetching_.erase(p->page_id_);
+    writes.push_back({p->page_id_, p->data_, true, [p]() { p->is_dirty_ = false; }});
+  }
+  disk_manager_->ExecuteBatch(writes);
+}
+
+page_id_t BufferPoolManager::AllocatePage(page_id_t near_page_id) {
+  int next_page_id = disk_manager_->AllocatePage(near_page_id);
   return next_page_id;
 }
 
@@ -195,10 +590,10 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 bool BufferPoolManager::CheckAllUnpinned() {
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+    if (pages_[i].pin_count_ != pages_[i].background_pins_) {
       res = false;
       LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
     }
   }
   return res;
-}
\ No newline at end of file
+}
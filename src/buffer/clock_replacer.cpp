@@ -0,0 +1,58 @@
+#include "buffer/clock_replacer.h"
+
+CLOCKReplacer::CLOCKReplacer(size_t num_pages)
+    : capacity_(num_pages), ref_bits_(num_pages, 0), evictable_(num_pages, 0) {}
+
+CLOCKReplacer::~CLOCKReplacer() = default;
+
+bool CLOCKReplacer::Victim(frame_id_t *frame_id) {
+  if (size_ == 0) {
+    return false;
+  }
+  // terminates within two sweeps: the first one clears every reference bit it passes
+  while (true) {
+    size_t cur = hand_;
+    hand_ = (hand_ + 1) % capacity_;
+    if (!evictable_[cur]) {
+      continue;
+    }
+    if (ref_bits_[cur]) {
+      ref_bits_[cur] = 0;
+      continue;
+    }
+    evictable_[cur] = 0;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(cur);
+    return true;
+  }
+}
+
+void CLOCKReplacer::Pin(frame_id_t frame_id) {
+  if (!IsValidFrame(frame_id)) {
+    return;
+  }
+  if (evictable_[frame_id]) {
+    evictable_[frame_id] = 0;
+    size_--;
+  }
+}
+
+void CLOCKReplacer::Unpin(frame_id_t frame_id) {
+  if (!IsValidFrame(frame_id) || evictable_[frame_id]) {
+    return;
+  }
+  evictable_[frame_id] = 1;
+  ref_bits_[frame_id] = 1;
+  size_++;
+}
+
+void CLOCKReplacer::Remove(frame_id_t frame_id) {
+  Pin(frame_id);
+  if (IsValidFrame(frame_id)) {
+    ref_bits_[frame_id] = 0;
+  }
+}
+
+size_t CLOCKReplacer::Size() {
+  return size_;
+}
@@ -0,0 +1,69 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : num_pages_(num_pages), k_(k), frames_(num_pages) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  // frames with an infinite backward k-distance go first
+  auto &list = cold_list_.empty() ? hot_list_ : cold_list_;
+  if (list.empty()) {
+    return false;
+  }
+  *frame_id = list.begin()->second;
+  list.erase(list.begin());
+  // the page leaves the buffer pool, forget its history
+  frames_[*frame_id].history_.clear();
+  frames_[*frame_id].evictable_ = false;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    (entry.history_.size() < k_ ? cold_list_ : hot_list_).erase(EvictKey(entry, frame_id));
+    entry.evictable_ = false;
+  }
+  RecordAccess(entry);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    return;
+  }
+  if (entry.history_.empty()) {
+    RecordAccess(entry);
+  }
+  entry.evictable_ = true;
+  (entry.history_.size() < k_ ? cold_list_ : hot_list_).insert(EvictKey(entry, frame_id));
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    (entry.history_.size() < k_ ? cold_list_ : hot_list_).erase(EvictKey(entry, frame_id));
+    entry.evictable_ = false;
+  }
+  entry.history_.clear();
+}
+
+size_t LRUKReplacer::Size() {
+  return cold_list_.size() + hot_list_.size();
+}
+
+void LRUKReplacer::RecordAccess(FrameEntry &entry) {
+  entry.history_.push_back(current_timestamp_++);
+  if (entry.history_.size() > k_) {
+    entry.history_.pop_front();
+  }
+}
@@ -111,7 +111,8 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
  */
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info, const string &index_type) {
+                                    IndexInfo *&index_info, const string &index_type,
+                                    [[maybe_unused]] const std::vector<std::string> &include_keys) {
   // ASSERT(false, "Not Implemented yet");
   return DB_FAILED;
 }
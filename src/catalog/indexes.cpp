@@ -1,12 +1,21 @@
 #include "catalog/indexes.h"
 
+#include <iterator>
+
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, const std::string &index_type,
+                             const std::vector<uint32_t> &include_map)
+    : index_id_(index_id),
+      index_name_(index_name),
+      table_id_(table_id),
+      key_map_(key_map),
+      index_type_(index_type),
+      include_map_(include_map) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, const string &index_type,
+                                     const vector<uint32_t> &include_map) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, index_type, include_map);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -35,15 +44,26 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
         MACH_WRITE_UINT32(buf, col_index);
         buf += 4;
     }
+    // index type
+    MACH_WRITE_UINT32(buf, index_type_.length());
+    buf += 4;
+    MACH_WRITE_STRING(buf, index_type_);
+    buf += index_type_.length();
+    // included columns
+    MACH_WRITE_UINT32(buf, include_map_.size());
+    buf += 4;
+    for (auto &col_index : include_map_) {
+        MACH_WRITE_UINT32(buf, col_index);
+        buf += 4;
+    }
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
     return ofs;
 }
 
-/**
- * TODO: Student Implement
- */
 uint32_t IndexMetadata::GetSerializedSize() const {
-  return 0;
+  // magic num, index id, name length, table id, key count, type length and include count take 4 bytes each
+  return 7 * sizeof(uint32_t) + index_name_.length() + index_type_.length() +
+         (key_map_.size() + include_map_.size()) * sizeof(uint32_t);
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
@@ -76,34 +96,49 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
         buf += 4;
         key_map.push_back(key_index);
     }
+    // index type
+    len = MACH_READ_UINT32(buf);
+    buf += 4;
+    std::string index_type(buf, len);
+    buf += len;
+    // included columns
+    uint32_t include_count = MACH_READ_UINT32(buf);
+    buf += 4;
+    std::vector<uint32_t> include_map;
+    for (uint32_t i = 0; i < include_count; i++) {
+        include_map.push_back(MACH_READ_UINT32(buf));
+        buf += 4;
+    }
     // allocate space for index meta data
-    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, index_type, include_map);
     return buf - p;
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  for (auto col : key_schema_->GetColumns()) {
-    max_size += col->GetLength();
+  // room for the encoded key, not the raw column lengths: null bytes, char terminators and escapes take space too
+  size_t max_size = KeyManager::GetMaxKeySize(key_schema_);
+  bool unique = false;  // the key is unique if one of its columns is, included columns do not count
+  uint32_t include_count = meta_data_->GetIncludeMapping().size();
+  uint32_t key_count = key_schema_->GetColumnCount() - include_count;
+  for (uint32_t i = 0; i < key_count; i++) {
+    unique = unique || key_schema_->GetColumn(i)->IsUnique();
+  }
+  if (index_type == "hash" && include_count > 0) {
+    LOG(ERROR) << "A hash index can not include columns";
+    return nullptr;
   }
 
-  if (index_type == "bptree") {
-    if (max_size <= 8)
-      max_size = 16;
-    else if (max_size <= 24)
-      max_size = 32;
-    else if (max_size <= 56)
-      max_size = 64;
-    else if (max_size <= 120)
-      max_size = 128;
-    else if (max_size <= 248)
-      max_size = 256;
-    else {
-      LOG(ERROR) << "GenericKey size is too large";
-      return nullptr;
-    }
-  } else {
+  if (index_type != "bptree" && index_type != "hash") {
+    return nullptr;
+  }
+  // the smallest key size with a specialized compare, a key on one int column gets 8 bytes
+  max_size = KeyManager::FitKeySize(max_size);
+  if (max_size > GENERIC_KEY_SIZES[std::size(GENERIC_KEY_SIZES) - 1]) {
+    LOG(ERROR) << "GenericKey size is too large";
     return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  if (index_type == "hash") {
+    return new ExtendibleHashIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique);
+  }
+  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique, include_count);
 }
@@ -3,7 +3,8 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size,
+                                 ReplacerType replacer_type)
     : db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
   db_file_name_ = "./databases/"+db_file_name_;
@@ -12,7 +13,8 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
   }
   // Initialize components
   disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, 1, replacer_type);
+  bpm_->StartPageCleaner();
 
   // Allocate static page for db storage engine
   if (init) {
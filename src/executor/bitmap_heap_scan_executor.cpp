@@ -0,0 +1,91 @@
+#include "executor/executors/bitmap_heap_scan_executor.h"
+
+#include <iterator>
+
+#include "executor/executors/index_scan_executor.h"
+
+BitmapHeapScanExecutor::BitmapHeapScanExecutor(ExecuteContext *exec_ctx, const BitmapHeapScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void BitmapHeapScanExecutor::Init() {
+  TableInfo *table_info = nullptr;
+  if (exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info) != DB_SUCCESS) {
+    throw std::logic_error("Table " + plan_->GetTableName() + " not exists.");
+  }
+  table_heap_ = table_info->GetTableHeap();
+  table_schema_ = table_info->GetSchema();
+  bitmap_.Clear();
+  BuildBitmap(*plan_->condition_, bitmap_);
+  page_iter_ = bitmap_.GetPages().begin();
+  prefetch_iter_ = page_iter_;
+  batch_.clear();
+  batch_index_ = 0;
+}
+
+void BitmapHeapScanExecutor::BuildBitmap(const BitmapIndexCondition &condition, RowIdBitmap &bitmap) {
+  if (condition.index_ != nullptr) {
+    auto cursor = IndexScanExecutor::OpenCursor(condition.index_, condition.key_range_, exec_ctx_->GetTransaction());
+    RowId next;
+    while (cursor->Next(next)) {
+      bitmap.Add(next);
+    }
+    return;
+  }
+  bool first = true;
+  for (auto &child : condition.children_) {
+    RowIdBitmap child_bitmap;
+    BuildBitmap(*child, first ? bitmap : child_bitmap);
+    if (!first) {
+      if (condition.logic_type_ == LogicType::And) {
+        bitmap.IntersectWith(child_bitmap);
+      } else {
+        bitmap.UnionWith(child_bitmap);
+      }
+    }
+    first = false;
+    // nothing is left to intersect with
+    if (condition.logic_type_ == LogicType::And && bitmap.Empty()) {
+      return;
+    }
+  }
+}
+
+bool BitmapHeapScanExecutor::FetchPage() {
+  auto &pages = bitmap_.GetPages();
+  if (page_iter_ == pages.end()) {
+    return false;
+  }
+  // the pages are known in advance, keep DEFAULT_PREFETCH_DEPTH of them being read ahead of the sweep
+  auto bpm = exec_ctx_->GetBufferPoolManager();
+  while (prefetch_iter_ != pages.end() &&
+         static_cast<size_t>(std::distance(page_iter_, prefetch_iter_)) <= DEFAULT_PREFETCH_DEPTH) {
+    if (bpm != nullptr && prefetch_iter_ != page_iter_) {
+      bpm->PrefetchPage(prefetch_iter_->first);
+    }
+    ++prefetch_iter_;
+  }
+  std::vector<uint32_t> slots;
+  RowIdBitmap::CollectSlots(page_iter_->second, slots);
+  batch_.clear();
+  batch_index_ = 0;
+  table_heap_->GetTuples(page_iter_->first, slots, batch_, exec_ctx_->GetTransaction(), &ring_);
+  ++page_iter_;
+  return true;
+}
+
+bool BitmapHeapScanExecutor::Next(Row *row, RowId *rid) {
+  auto predicate = plan_->GetPredicate();
+  while (batch_index_ < batch_.size() || FetchPage()) {
+    if (batch_index_ == batch_.size()) {
+      continue;
+    }
+    Row &cur = batch_[batch_index_++];
+    if (predicate == nullptr || predicate->Evaluate(&cur).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+      cur.GetKeyFromRow(table_schema_, plan_->OutputSchema(), *row);
+      *rid = cur.GetRowId();
+      row->SetRowId(*rid);
+      return true;
+    }
+  }
+  return false;
+}
@@ -7,6 +7,7 @@
 #include <chrono>
 
 #include "common/result_writer.h"
+#include "executor/executors/bitmap_heap_scan_executor.h"
 #include "executor/executors/delete_executor.h"
 #include "executor/executors/index_scan_executor.h"
 #include "executor/executors/insert_executor.h"
@@ -49,6 +50,10 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
     case PlanType::IndexScan: {
       return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
     }
+    case PlanType::BitmapHeapScan: {
+      return std::make_unique<BitmapHeapScanExecutor>(exec_ctx,
+                                                      dynamic_cast<const BitmapHeapScanPlanNode *>(plan.get()));
+    }
     // Create a new update executor
     case PlanType::Update: {
       auto update_plan = dynamic_cast<const UpdatePlanNode *>(plan.get());
@@ -158,7 +163,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   std::stringstream ss;
   ResultWriter writer(ss);
 
-  if (planner.plan_->GetType() == PlanType::SeqScan || planner.plan_->GetType() == PlanType::IndexScan) {
+  if (planner.plan_->GetType() == PlanType::SeqScan || planner.plan_->GetType() == PlanType::IndexScan ||
+      planner.plan_->GetType() == PlanType::BitmapHeapScan) {
     auto schema = planner.plan_->OutputSchema();
     auto num_of_columns = schema->GetColumnCount();
     if (!result_set.empty()) {
@@ -1,13 +1,69 @@
 #include "executor/executors/index_scan_executor.h"
-/**
-* TODO: Student Implement
-*/
+
+#include "planner/expressions/constant_value_expression.h"
+
 IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void IndexScanExecutor::Init() {
+  TableInfo *table_info = nullptr;
+  if (exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info) != DB_SUCCESS) {
+    throw std::logic_error("Table " + plan_->GetTableName() + " not exists.");
+  }
+  table_heap_ = table_info->GetTableHeap();
+  table_schema_ = table_info->GetSchema();
+  cursor_ = OpenCursor(plan_->indexes_[0], plan_->key_ranges_[0], exec_ctx_->GetTransaction(), plan_->index_only_);
+  key_columns_.assign(table_schema_->GetColumnCount(), -1);
+  auto key_schema = plan_->indexes_[0]->GetIndexKeySchema();
+  for (uint32_t i = 0; plan_->index_only_ && i < key_schema->GetColumnCount(); i++) {
+    key_columns_[key_schema->GetColumn(i)->GetTableInd()] = static_cast<int>(i);
+  }
+}
+
+std::unique_ptr<IndexCursor> IndexScanExecutor::OpenCursor(IndexInfo *index, const IndexKeyRange &range,
+                                                           Transaction *txn, bool with_keys) {
+  std::vector<Field> prefix;
+  for (auto &value : range.prefix_) {
+    prefix.emplace_back(value->Evaluate(nullptr));
+  }
+  std::unique_ptr<Field> lower, upper;
+  if (range.lower_ != nullptr) {
+    lower = std::make_unique<Field>(range.lower_->Evaluate(nullptr));
+  }
+  if (range.upper_ != nullptr) {
+    upper = std::make_unique<Field>(range.upper_->Evaluate(nullptr));
+  }
+  return index->GetIndex()->OpenCursor(prefix, lower.get(), range.lower_inclusive_, upper.get(),
+                                       range.upper_inclusive_, txn, with_keys);
 }
 
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
+  auto predicate = plan_->need_filter_ ? plan_->GetPredicate() : nullptr;
+  RowId next;
+  Row key;
+  while (plan_->index_only_ ? cursor_->Next(next, key) : cursor_->Next(next)) {
+    Row cur(next);
+    if (plan_->index_only_) {
+      // the row as far as the index stores it, the query reads no other column
+      std::vector<Field> fields;
+      for (uint32_t i = 0; i < table_schema_->GetColumnCount(); i++) {
+        if (key_columns_[i] >= 0) {
+          fields.emplace_back(*key.GetField(key_columns_[i]));
+        } else {
+          fields.emplace_back(table_schema_->GetColumn(i)->GetType());
+        }
+      }
+      cur = Row(fields);
+      cur.SetRowId(next);
+    } else if (!table_heap_->GetTuple(&cur, exec_ctx_->GetTransaction())) {
+      continue;
+    }
+    if (predicate == nullptr || predicate->Evaluate(&cur).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+      cur.GetKeyFromRow(table_schema_, plan_->OutputSchema(), *row);
+      *rid = cur.GetRowId();
+      row->SetRowId(*rid);
+      return true;
+    }
+  }
   return false;
 }
@@ -4,13 +4,92 @@
 
 #include "executor/executors/insert_executor.h"
 
+#include <algorithm>
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
 void InsertExecutor::Init() {
+  child_executor_->Init();
+  if (exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_) != DB_SUCCESS) {
+    throw std::logic_error("Table " + plan_->GetTableName() + " not exists.");
+  }
+  indexes_.clear();
+  exec_ctx_->GetCatalog()->GetTableIndexes(plan_->GetTableName(), indexes_);
+  batch_.clear();
+  cursor_ = 0;
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
+  if (cursor_ == batch_.size()) {
+    batch_.clear();
+    cursor_ = 0;
+    Row child_row;
+    RowId child_rid;
+    while (batch_.size() < BULK_INSERT_BATCH_SIZE && child_executor_->Next(&child_row, &child_rid)) {
+      batch_.push_back(child_row);
+    }
+    if (batch_.empty()) {
+      return false;
+    }
+    InsertBatch(table_info_, indexes_, batch_, exec_ctx_->GetTransaction());
+  }
+  // one output row per inserted row, so the engine reports the number of affected rows
+  *row = batch_[cursor_];
+  *rid = batch_[cursor_].GetRowId();
+  cursor_++;
+  return true;
+}
+
+bool InsertExecutor::KeyLess(const Row &a, const Row &b) {
+  for (uint32_t i = 0; i < a.GetFieldCount(); i++) {
+    if (a.GetField(i)->CompareLessThan(*b.GetField(i)) == CmpBool::kTrue) {
+      return true;
+    }
+    if (a.GetField(i)->CompareGreaterThan(*b.GetField(i)) == CmpBool::kTrue) {
+      return false;
+    }
+  }
   return false;
-}
\ No newline at end of file
+}
+
+void InsertExecutor::InsertBatch(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, std::vector<Row> &batch,
+                                 Transaction *txn) {
+  Schema *schema = table_info->GetSchema();
+  // the key of every row for every index, sorted so that each index is filled in key order
+  std::vector<std::vector<std::pair<Row, size_t>>> index_keys(indexes.size());
+  for (size_t i = 0; i < indexes.size(); i++) {
+    auto &keys = index_keys[i];
+    keys.reserve(batch.size());
+    for (size_t j = 0; j < batch.size(); j++) {
+      Row key;
+      batch[j].GetKeyFromRow(schema, indexes[i]->GetIndexKeySchema(), key);
+      keys.emplace_back(std::move(key), j);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const auto &a, const auto &b) { return KeyLess(a.first, b.first); });
+    if (!indexes[i]->IsUnique()) {
+      continue;
+    }
+    // reject the whole batch before anything is written
+    for (size_t j = 0; j < keys.size(); j++) {
+      std::vector<RowId> result;
+      bool duplicate = j > 0 && !KeyLess(keys[j - 1].first, keys[j].first);
+      if (!duplicate) {
+        indexes[i]->GetIndex()->ScanKey(keys[j].first, result, txn);
+        duplicate = !result.empty();
+      }
+      if (duplicate) {
+        throw std::logic_error("Duplicate entry for key of index " + indexes[i]->GetIndexName() + ".");
+      }
+    }
+  }
+  if (!table_info->GetTableHeap()->BulkInsert(batch, txn)) {
+    throw std::logic_error("Failed to insert into table " + table_info->GetTableName() + ".");
+  }
+  for (size_t i = 0; i < indexes.size(); i++) {
+    for (auto &key : index_keys[i]) {
+      indexes[i]->GetIndex()->InsertEntry(key.first, batch[key.second].GetRowId(), txn);
+    }
+  }
+}
@@ -11,8 +11,27 @@ SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode
       plan_(plan){}
 
 void SeqScanExecutor::Init() {
+  TableInfo *table_info = nullptr;
+  if (exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info) != DB_SUCCESS) {
+    throw std::logic_error("Table " + plan_->GetTableName() + " not exists.");
+  }
+  table_heap_ = table_info->GetTableHeap();
+  table_schema_ = table_info->GetSchema();
+  iter_ = std::make_unique<TableIterator>(table_heap_->Begin(exec_ctx_->GetTransaction(), &ring_));
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+  auto predicate = plan_->GetPredicate();
+  while (*iter_ != table_heap_->End()) {
+    Row *cur = iter_->operator->();
+    if (predicate == nullptr || predicate->Evaluate(cur).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue) {
+      cur->GetKeyFromRow(table_schema_, plan_->OutputSchema(), *row);
+      *rid = cur->GetRowId();
+      row->SetRowId(*rid);
+      ++(*iter_);
+      return true;
+    }
+    ++(*iter_);
+  }
   return false;
 }
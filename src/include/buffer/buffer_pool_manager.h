@@ -1,10 +1,19 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/buffer_ring.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
@@ -12,19 +21,52 @@
 
 using namespace std;
 
+/**
+ * BufferPoolManager caches disk pages in memory frames.
+ *
+ * The pool can be partitioned into several independent instances. A page is always served by the instance
+ * `page_id % num_instances`, and every instance owns its own frames, page table, free list, replacer and latch, so
+ * threads touching different pages rarely contend with each other. With one instance (the default) the manager
+ * behaves exactly like a single shared pool.
+ *
+ * The replacement policy of every instance is chosen by `replacer_type`: plain LRU, LRU-K which keeps pages that
+ * are referenced repeatedly (index inner nodes, catalog pages) in memory while a sequential scan streams through, or
+ * CLOCK which approximates LRU without any per-unpin allocation.
+ *
+ * An optional background page cleaner (StartPageCleaner) writes unpinned dirty pages out ahead of demand, so that a
+ * miss in FetchPage / NewPage almost always finds a clean victim instead of writing one back on the caller's path.
+ * It writes copies of the pages taken under the instance latch, and does the I/O itself with the latch released.
+ *
+ * PrefetchPage queues asynchronous read-ahead: a background I/O thread loads pages into unpinned frames so that the
+ * FetchPage of an iterator crossing into the next page of a chain finds it already cached.
+ */
 class BufferPoolManager {
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /** Given a cached page, return the id of the page following it in its chain (INVALID_PAGE_ID at the end). */
+  using NextPageFunc = page_id_t (*)(Page *page);
+
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances = 1,
+                             ReplacerType replacer_type = ReplacerType::kLRU);
 
   ~BufferPoolManager();
 
   Page *FetchPage(page_id_t page_id);
 
+  /**
+   * Fetch a page on behalf of a sequential scan. A page that has to be read from disk goes through the ring's frames
+   * instead of competing with the rest of the pool, see BufferRing. A null ring behaves like FetchPage(page_id).
+   */
+  Page *FetchPage(page_id_t page_id, BufferRing *ring);
+
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
   bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Allocate a new page and pin it. Chains that grow page by page (table heaps, index levels) pass the page they grow
+   * from as `near_page_id`, so the new page is placed physically next to it, see DiskManager::AllocatePage.
+   */
+  Page *NewPage(page_id_t &page_id, page_id_t near_page_id = INVALID_PAGE_ID);
 
   bool DeletePage(page_id_t page_id);
 
@@ -32,27 +74,156 @@ class BufferPoolManager {
 
   bool CheckAllUnpinned();
 
+  /** @return the total number of frames over all instances */
+  inline size_t GetPoolSize() const { return pool_size_; }
+
+  /** @return the number of independent instances the pool is partitioned into */
+  inline size_t GetNumInstances() const { return instances_.size(); }
+
+  /**
+   * Start the background page cleaner. Every `interval_ms` (or as soon as a miss had to write a dirty victim) it makes
+   * sure at least `clean_target` of the frames of every instance are free or hold an unpinned clean page, writing
+   * unpinned dirty pages in page id order until the target is met. Does nothing if the cleaner is already running.
+   */
+  void StartPageCleaner(double clean_target = DEFAULT_PAGE_CLEANER_TARGET,
+                        uint32_t interval_ms = DEFAULT_PAGE_CLEANER_INTERVAL);
+
+  /** Stop the background page cleaner and wait for it to exit. Called by the destructor. */
+  void StopPageCleaner();
+
+  /**
+   * Asynchronously load `page_id` into the pool without pinning it. If `next_page` is given, keep following the chain
+   * for up to `depth` pages in total. Pages already cached are skipped, and the request is silently dropped when the
+   * read-ahead queue is full or no frame can be freed, so this is only ever a hint.
+   */
+  void PrefetchPage(page_id_t page_id, size_t depth = 1, NextPageFunc next_page = nullptr);
+
+  /** @return number of pages read from disk by read-ahead, see DiskManager::ExecuteBatch for how they are batched */
+  inline uint64_t GetPrefetchReadCount() const { return prefetch_reads_.load(); }
+
+  /** @return number of dirty victims written back synchronously by FetchPage / NewPage */
+  inline uint64_t GetForegroundWriteCount() const { return foreground_writes_.load(); }
+
+  /** @return number of pages written back by the background page cleaner */
+  inline uint64_t GetBackgroundWriteCount() const { return background_writes_.load(); }
+
  private:
+  /**
+   * One partition of the buffer pool. Frame ids are local to the instance and index into `pages_`.
+   */
+  struct BufferPoolInstance {
+    size_t pool_size_;                                 // number of pages in this instance
+    Page *pages_;                                      // frames owned by this instance (slice of the global array)
+    unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+    Replacer *replacer_;                               // to find an unpinned page for replacement
+    list<frame_id_t> free_list_;                       // to find a free page for replacement
+    recursive_mutex latch_;                            // to protect shared data structure
+    unordered_set<page_id_t> prefetching_;             // pages being read ahead, a fetch or write-back removes them
+    std::mutex background_latch_;                      // protects background_releases_, clearing Page::writing_
+    std::condition_variable background_cv_;            // signalled on a background unpin or a finished write-back
+    uint64_t background_releases_{0};                  // background unpins so far, DeletePage waits for the next one
+  };
+
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    size_t depth_;
+    NextPageFunc next_page_;
+    bool registered_;  // page_id_ was put in prefetching_ by PrefetchPage
+  };
+
+  inline BufferPoolInstance &GetInstance(page_id_t page_id) {
+    return *instances_[static_cast<size_t>(page_id) % instances_.size()];
+  }
+
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t near_page_id);
 
   /**
    * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
    */
   void DeallocatePage(page_id_t page_id);
 
-  frame_id_t TryToFindFreePage();
+  /**
+   * Pick a frame for a new page from the free list first, then from the replacer. A dirty victim is written back and
+   * its page table entry removed. Caller must hold the instance latch.
+   * @return the frame id, or INVALID_FRAME_ID if every frame is pinned
+   */
+  frame_id_t TryToFindFreePage(BufferPoolInstance &instance);
+
+  /**
+   * Drop an unpinned page from the pool and put its frame back on the free list, writing it back first if dirty.
+   * @return false if the page is not resident or still pinned
+   */
+  bool EvictPage(page_id_t page_id);
+
+  /** Write a frame back to disk if it is dirty. Caller must hold the instance latch. */
+  void FlushFrame(Page *page);
+
+  /**
+   * Write dirty frames back with one batch of asynchronous I/O. Caller must hold the latches of the instances owning
+   * the pages (or be the only thread left).
+   */
+  void FlushFrames(const std::vector<std::pair<page_id_t, Page *>> &pages);
+
+  /** Main loop of the read-ahead thread. */
+  void PrefetchLoop();
+
+  /**
+   * Check whether a read-ahead target is cached already. If it is not (and allocated), register it as being read.
+   * A `registered` page missing from prefetching_ was read by a fetch since the request was queued: the scan that
+   * asked for it is past it already, and the request is dropped.
+   * @param[out] next_page_id the next page of the chain according to `next_page` if cached, else INVALID_PAGE_ID
+   * @return true if the page has to be read from disk
+   */
+  bool PrefetchLookup(page_id_t page_id, NextPageFunc next_page, bool registered, page_id_t *next_page_id);
+
+  /**
+   * Put a page read by read-ahead into an unpinned frame, unless it got cached or written back meanwhile.
+   * @return the next page of the chain according to `next_page`, INVALID_PAGE_ID to stop following it
+   */
+  page_id_t PrefetchInstall(page_id_t page_id, const char *data, NextPageFunc next_page);
+
+  /**
+   * Pin a cached frame for a background thread of the pool (read-ahead, page cleaner). DeletePage waits for such a pin
+   * instead of failing, and CheckAllUnpinned does not count it. Caller must hold the latch of `instance`.
+   */
+  void PinBackground(BufferPoolInstance &instance, frame_id_t frame_id);
+
+  /** Release a pin taken by PinBackground. */
+  void UnpinBackground(Page *page);
+
+  /** Follow the chain from a page pinned by PinBackground, then unpin it. Caller must not hold any instance latch. */
+  page_id_t ReadNextPageId(Page *page, NextPageFunc next_page);
+
+  /** Main loop of the page cleaner thread. */
+  void PageCleanerLoop(double clean_target, uint32_t interval_ms);
+
+  /**
+   * One cleaning round over one instance.
+   * @return number of pages written
+   */
+  size_t CleanInstance(BufferPoolInstance &instance, double clean_target);
 
  private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
-  DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
-  list<frame_id_t> free_list_;                       // to find a free page for replacement
-  recursive_mutex latch_;                            // to protect shared data structure
+  size_t pool_size_;                                // number of pages in buffer pool
+  Page *pages_;                                     // array of pages
+  DiskManager *disk_manager_;                       // pointer to the disk manager.
+  std::vector<BufferPoolInstance *> instances_;     // partitions of the pool
+  std::thread page_cleaner_;                        // background writer, see StartPageCleaner
+  std::mutex page_cleaner_latch_;                   // protects page_cleaner_stop_ and page_cleaner_wakeup_
+  std::condition_variable page_cleaner_cv_;
+  bool page_cleaner_stop_{false};
+  bool page_cleaner_wakeup_{false};
+  std::atomic<uint64_t> foreground_writes_{0};
+  std::atomic<uint64_t> background_writes_{0};
+  std::thread prefetcher_;                          // read-ahead thread, started by the first PrefetchPage
+  std::mutex prefetch_latch_;                       // protects prefetch_queue_ and prefetch_stop_
+  std::condition_variable prefetch_cv_;
+  std::deque<PrefetchRequest> prefetch_queue_;
+  bool prefetch_stop_{false};
+  std::atomic<uint64_t> prefetch_reads_{0};
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,35 @@
+#ifndef MINISQL_BUFFER_RING_H
+#define MINISQL_BUFFER_RING_H
+
+#include <vector>
+
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * BufferRing is a bulk-read access strategy for the buffer pool.
+ *
+ * A sequential scan touches every page of a table exactly once, so letting those pages enter the pool like any other
+ * page would flush out the pages the rest of the system actually reuses. A scan that passes a ring to
+ * `BufferPoolManager::FetchPage` instead remembers the last `ring_size` pages it had to read from disk; before reading
+ * another one, the oldest of them is dropped from the pool again (if nobody pinned it meanwhile), so the scan keeps
+ * cycling through a fixed handful of frames. Pages that were already cached are served as usual and never recycled.
+ *
+ * A ring is owned by one scan and is not thread safe.
+ */
+class BufferRing {
+  friend class BufferPoolManager;
+
+ public:
+  explicit BufferRing(size_t ring_size = DEFAULT_BUFFER_RING_SIZE) : slots_(ring_size, INVALID_PAGE_ID) {}
+
+  /** @return the number of frames the ring cycles through */
+  inline size_t GetRingSize() const { return slots_.size(); }
+
+ private:
+  vector<page_id_t> slots_;  // pages read through this ring, INVALID_PAGE_ID for unused slots
+  size_t next_slot_{0};      // slot to recycle on the next read
+};
+
+#endif  // MINISQL_BUFFER_RING_H
@@ -1,12 +1,6 @@
 #ifndef MINISQL_CLOCK_REPLACER_H
 #define MINISQL_CLOCK_REPLACER_H
 
-#include <algorithm>
-#include <list>
-#include <map>
-#include <mutex>
-#include <queue>
-#include <unordered_set>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -15,7 +9,11 @@
 using namespace std;
 
 /**
- * CLOCKReplacer implements the clock replacement.
+ * CLOCKReplacer implements the clock (second chance) replacement.
+ *
+ * Reference bits and evictable flags live in flat arrays indexed by frame id and a hand sweeps over them: an evictable
+ * frame with its reference bit set gets a second chance (the bit is cleared), the first evictable frame found with a
+ * clear bit is the victim. Pin and Unpin are O(1) and never allocate, Victim is amortized O(1).
  */
 class CLOCKReplacer : public Replacer {
  public:
@@ -36,12 +34,20 @@ class CLOCKReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
  private:
-  size_t capacity;
-  list<frame_id_t> clock_list;               // replacer中可以被替换的数据页
-  map<frame_id_t, frame_id_t> clock_status;  // 数据页的存储状态
+  inline bool IsValidFrame(frame_id_t frame_id) const {
+    return frame_id >= 0 && static_cast<size_t>(frame_id) < capacity_;
+  }
+
+  size_t capacity_;
+  size_t size_{0};           // number of evictable frames
+  size_t hand_{0};           // next frame the clock hand looks at
+  vector<uint8_t> ref_bits_;   // reference bit of each frame
+  vector<uint8_t> evictable_;  // whether the frame can be victimized
 };
 
-#endif  // MINISQL_CLOCK_REPLACER_H
\ No newline at end of file
+#endif  // MINISQL_CLOCK_REPLACER_H
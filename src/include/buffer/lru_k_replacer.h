@@ -0,0 +1,70 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The replacer remembers the timestamps of the last K references of every frame. The victim is the evictable frame
+ * whose backward K-distance (now - timestamp of its K-th most recent reference) is the largest. Frames referenced
+ * fewer than K times have an infinite backward K-distance and are evicted first, oldest first reference first, so a
+ * page touched once by a sequential scan is always dropped before a page that has been reused.
+ *
+ * A reference is recorded every time a frame is pinned.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameEntry {
+    deque<uint64_t> history_;  // timestamps of the last k references, oldest first
+    bool evictable_{false};
+  };
+
+  /** Record a reference to the frame at the current timestamp. */
+  void RecordAccess(FrameEntry &entry);
+
+  /** @return the key of an evictable frame inside cold_list_ or hot_list_ */
+  inline pair<uint64_t, frame_id_t> EvictKey(const FrameEntry &entry, frame_id_t frame_id) const {
+    return make_pair(entry.history_.front(), frame_id);
+  }
+
+  size_t num_pages_;
+  size_t k_;
+  uint64_t current_timestamp_{0};
+  vector<FrameEntry> frames_;
+  set<pair<uint64_t, frame_id_t>> cold_list_;  // evictable frames with less than k references
+  set<pair<uint64_t, frame_id_t>> hot_list_;   // evictable frames with k references, ordered by k-th reference
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
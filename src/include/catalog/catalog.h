@@ -82,9 +82,10 @@ class CatalogManager {
 
   dberr_t GetTables(std::vector<TableInfo *> &tables) const;
 
+  /** `include_keys` are stored in the index after `index_keys` (CREATE INDEX ... INCLUDE), see IndexMetadata. */
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Transaction *txn, IndexInfo *&index_info,
-                      const string &index_type);
+                      const string &index_type, const std::vector<std::string> &include_keys = {});
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
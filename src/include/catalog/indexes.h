@@ -7,6 +7,7 @@
 #include "common/macros.h"
 #include "common/rowid.h"
 #include "index/b_plus_tree_index.h"
+#include "index/extendible_hash_index.h"
 #include "index/generic_key.h"
 #include "record/schema.h"
 
@@ -15,7 +16,8 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, const std::string &index_type = "bptree",
+                               const std::vector<uint32_t> &include_map = {});
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,11 +35,21 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  /** @return "bptree" or "hash", see IndexInfo::CreateIndex */
+  inline const std::string &GetIndexType() const { return index_type_; }
+
+  /**
+   * Columns stored in the index after the key columns, so that queries reading only them never fetch the row. They do
+   * not take part in uniqueness or in key lookups, and the key schema of the index is the key columns followed by them.
+   */
+  inline const std::vector<uint32_t> &GetIncludeMapping() const { return include_map_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, const std::string &index_type,
+                         const std::vector<uint32_t> &include_map);
 
  private:
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
@@ -45,6 +57,8 @@ class IndexMetadata {
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  std::string index_type_;
+  std::vector<uint32_t> include_map_; /** The mapping of included columns to tuple key */
 };
 
 /**
@@ -60,14 +74,13 @@ class IndexInfo {
     delete key_schema_;
   }
 
-/**
- * TODO: Student Implement
- */
+  /** Take over `meta_data`, and open the index on the key columns of `table_info` followed by its included columns. */
   void Init(IndexMetadata *meta_data, TableInfo *table_info, BufferPoolManager *buffer_pool_manager) {
-    // Step1: init index metadata and table info
-    // Step2: mapping index key to key schema
-    // Step3: call CreateIndex to create the index
-    ASSERT(false, "Not Implemented yet.");
+    meta_data_ = meta_data;
+    std::vector<uint32_t> key_map = meta_data_->GetKeyMapping();
+    key_map.insert(key_map.end(), meta_data_->GetIncludeMapping().begin(), meta_data_->GetIncludeMapping().end());
+    key_schema_ = Schema::ShallowCopySchema(table_info->GetSchema(), key_map);
+    index_ = CreateIndex(buffer_pool_manager, meta_data_->GetIndexType());
   }
 
   inline Index *GetIndex() { return index_; }
@@ -76,6 +89,11 @@ class IndexInfo {
 
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  const std::string &GetIndexType() { return meta_data_->GetIndexType(); }
+
+  /** @return whether the index rejects a second row with the same key, see Index::IsUnique */
+  bool IsUnique() { return index_->IsUnique(); }
+
  private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr} {}
 
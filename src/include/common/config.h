@@ -1,6 +1,7 @@
 #ifndef MINISQL_CONFIG_H
 #define MINISQL_CONFIG_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
@@ -13,8 +14,20 @@ static constexpr int META_PAGE_ID = 0;          // physical page id of the disk
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
-static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int PAGE_SIZE = 4096;                         // size of a data page in byte
+static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;         // default size of buffer pool
+static constexpr size_t LRUK_REPLACER_K = 2;                   // number of references remembered by the LRU-K replacer
+static constexpr size_t DEFAULT_BUFFER_RING_SIZE = 32;         // frames a sequential scan cycles through
+static constexpr double DEFAULT_PAGE_CLEANER_TARGET = 0.25;    // fraction of frames the page cleaner keeps clean
+static constexpr uint32_t DEFAULT_PAGE_CLEANER_INTERVAL = 10;  // ms the page cleaner sleeps between rounds
+static constexpr size_t DEFAULT_PREFETCH_DEPTH = 4;            // pages an iterator reads ahead of its position
+static constexpr size_t MAX_PREFETCH_QUEUE_SIZE = 64;          // pending read-ahead requests before new ones drop
+static constexpr uint32_t DEFAULT_IO_QUEUE_DEPTH = 32;         // page I/Os in flight when io_uring is enabled
+static constexpr uint32_t EXTENT_RUN_SIZE = 64;                // adjacent pages reserved for a growing table / index
+static constexpr size_t BULK_INSERT_BATCH_SIZE = 4096;         // rows an INSERT hands to TableHeap::BulkInsert at once
+static constexpr double DEFAULT_INDEX_FILL_FACTOR = 0.9;      // fraction of each B+ tree page a bulk load fills
+static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 << 20;    // bytes of index entries sorted in memory per run
+static constexpr int INDEX_INLINE_POSTING_SIZE = 3;           // row ids a non-unique index keeps in the leaf per key
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
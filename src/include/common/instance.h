@@ -14,7 +14,8 @@
 
 class DBStorageEngine {
  public:
-  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE);
+  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           ReplacerType replacer_type = ReplacerType::kLRU);
 
   ~DBStorageEngine();
 
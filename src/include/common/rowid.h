@@ -29,6 +29,11 @@ class RowId {
 
   bool operator==(const RowId &other) const { return page_id_ == other.page_id_ && slot_num_ == other.slot_num_; }
 
+  /** Row ids order by page, then slot, i.e. in the order of a sequential scan. */
+  bool operator<(const RowId &other) const {
+    return page_id_ < other.page_id_ || (page_id_ == other.page_id_ && slot_num_ < other.slot_num_);
+  }
+
  private:
   page_id_t page_id_{INVALID_PAGE_ID};
   uint32_t slot_num_{0};  // logical offset of the record in page, starts from 0. eg:0, 1, 2...
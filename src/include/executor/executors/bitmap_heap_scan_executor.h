@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_ring.h"
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/bitmap_heap_scan_plan.h"
+#include "storage/row_id_bitmap.h"
+
+/**
+ * The BitmapHeapScanExecutor collects the row ids of the index key ranges of its plan into a RowIdBitmap, intersecting
+ * and uniting the bitmaps of the ranges as the plan says, and then sweeps the table pages of the bitmap in page order,
+ * pinning each page once to read all of its matching rows. Pages ahead of the sweep are read ahead, and the sweep goes
+ * through a BufferRing like a sequential scan.
+ *
+ * Every row id is collected by Init, before the first row is returned, so an UPDATE or DELETE on top of this scan may
+ * change the indexes it read without the scan ever seeing the changed rows.
+ */
+class BitmapHeapScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new BitmapHeapScanExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The bitmap heap scan plan to be executed
+   */
+  BitmapHeapScanExecutor(ExecuteContext *exec_ctx, const BitmapHeapScanPlanNode *plan);
+
+  /** Build the bitmap from the index */
+  void Init() override;
+
+  /**
+   * Yield the next row of the sweep.
+   * @param[out] row The next row produced by the scan
+   * @param[out] rid The next row RID produced by the scan
+   * @return `true` if a row was produced, `false` if there are no more rows
+   */
+  bool Next(Row *row, RowId *rid) override;
+
+  /** @return The output schema for the bitmap heap scan */
+  const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+ private:
+  /** Add the row ids `condition` selects to the empty `bitmap`. */
+  void BuildBitmap(const BitmapIndexCondition &condition, RowIdBitmap &bitmap);
+
+  /** Read the rows of the next page of the bitmap into `batch_`. @return false past the last page */
+  bool FetchPage();
+
+  /** The bitmap heap scan plan node to be executed */
+  const BitmapHeapScanPlanNode *plan_;
+  /** Bulk-read strategy so the sweep does not flush the buffer pool */
+  BufferRing ring_;
+  TableHeap *table_heap_{nullptr};
+  Schema *table_schema_{nullptr};
+  RowIdBitmap bitmap_;
+  /** The next page of the bitmap to read, and the page the read-ahead has reached */
+  RowIdBitmap::PageMap::const_iterator page_iter_;
+  RowIdBitmap::PageMap::const_iterator prefetch_iter_;
+  /** Rows of the current page */
+  std::vector<Row> batch_;
+  size_t batch_index_{0};
+};
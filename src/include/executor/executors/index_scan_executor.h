@@ -1,15 +1,19 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/index_scan_plan.h"
+#include "index/index.h"
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 
 /**
- * The IndexScanExecutor executor can over a table.
+ * The IndexScanExecutor scans the key range of an index and fetches the rows it points to, checking only the
+ * residual predicate the key range does not answer. An index-only scan takes the columns from the index entries and
+ * never reads the table.
  */
 class IndexScanExecutor : public AbstractExecutor {
  public:
@@ -34,8 +38,18 @@ class IndexScanExecutor : public AbstractExecutor {
   /** @return The output schema for the sequential scan */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
+  /** Open a cursor over the key range `range` of `index`, evaluating its constant bounds. */
+  static std::unique_ptr<IndexCursor> OpenCursor(IndexInfo *index, const IndexKeyRange &range, Transaction *txn,
+                                                 bool with_keys = false);
+
  private:
 
   /** The sequential scan plan node to be executed */
   const IndexScanPlanNode *plan_;
+  TableHeap *table_heap_{nullptr};
+  Schema *table_schema_{nullptr};
+  /** Row ids of the key range, in key order, read from the index as rows are pulled */
+  std::unique_ptr<IndexCursor> cursor_;
+  /** For an index-only scan, the column of the index key schema holding each table column, -1 if none */
+  std::vector<int> key_columns_;
 };
\ No newline at end of file
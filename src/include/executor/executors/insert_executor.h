@@ -12,7 +12,9 @@
 /**
  * InsertExecutor executes an insert on a table.
  *
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. They are inserted in batches of BULK_INSERT_BATCH_SIZE
+ * rows through TableHeap::BulkInsert, and the index entries of a batch are sorted per index before they are applied.
+ * A batch repeating a key of a unique index, or a key already in it, is rejected before anything is written.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -41,10 +43,25 @@ class InsertExecutor : public AbstractExecutor {
   /** @return The output schema for the insert */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
+  /**
+   * Check every index for duplicate keys, then insert `batch` into the table and its `indexes`; the rows get their
+   * row ids. Throws std::logic_error, with nothing written, if a unique index would get a key twice.
+   */
+  static void InsertBatch(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, std::vector<Row> &batch,
+                          Transaction *txn);
+
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
+  TableInfo *table_info_{nullptr};
+  std::vector<IndexInfo *> indexes_;
+  /** Rows of the current batch, handed out by Next once they are inserted */
+  std::vector<Row> batch_;
+  size_t cursor_{0};
+
+  /** Order index keys field by field. */
+  static bool KeyLess(const Row &a, const Row &b);
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -5,8 +5,10 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_ring.h"
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/seq_scan_plan.h"
@@ -40,6 +42,11 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** Bulk-read strategy so the scan does not flush the buffer pool */
+  BufferRing ring_;
+  TableHeap *table_heap_{nullptr};
+  Schema *table_schema_{nullptr};
+  std::unique_ptr<TableIterator> iter_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
@@ -15,6 +15,7 @@
 enum class PlanType {
   SeqScan,
   IndexScan,
+  BitmapHeapScan,
   Insert,
   Update,
   Delete,
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "abstract_plan.h"
+#include "catalog/catalog.h"
+#include "executor/plans/index_scan_plan.h"
+#include "planner/expressions/abstract_expression.h"
+#include "planner/expressions/logic_expression.h"
+
+/**
+ * Where the row ids of a bitmap heap scan come from: a leaf scans one key range of an index, an inner node ANDs or ORs
+ * the row ids of its children.
+ */
+struct BitmapIndexCondition {
+  /** The index of a leaf, nullptr for an inner node */
+  IndexInfo *index_{nullptr};
+  IndexKeyRange key_range_;
+
+  /** How an inner node combines its children */
+  LogicType logic_type_{LogicType::And};
+  std::vector<std::shared_ptr<const BitmapIndexCondition>> children_;
+};
+
+using BitmapIndexConditionRef = std::shared_ptr<const BitmapIndexCondition>;
+
+/**
+ * BitmapHeapScanPlanNode collects row ids from the key ranges of one or more indexes first, combining them with AND
+ * and OR, and then reads the table pages holding them, each page once and in page order. Rows come out in heap order
+ * rather than key order.
+ */
+class BitmapHeapScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new bitmap heap scan plan node.
+   * @param output the output format of this scan plan node
+   * @param table_name The identifier of table to be scanned
+   * @param condition The index key ranges to collect row ids from, and how to combine them
+   * @param filter_predicate The conjuncts of the WHERE clause the key ranges do not answer, nullptr if none
+   */
+  BitmapHeapScanPlanNode(const Schema *output, std::string table_name, BitmapIndexConditionRef condition,
+                         AbstractExpressionRef filter_predicate = nullptr)
+      : AbstractPlanNode(output, {}),
+        table_name_(std::move(table_name)),
+        condition_(std::move(condition)),
+        filter_predicate_(std::move(filter_predicate)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::BitmapHeapScan; }
+
+  /** @return The identifier of the table that should be scanned */
+  std::string GetTableName() const { return table_name_; }
+
+  AbstractExpressionRef GetPredicate() const { return filter_predicate_; }
+
+  /** The table name */
+  std::string table_name_;
+
+  /** The index key ranges the row ids come from */
+  BitmapIndexConditionRef condition_;
+
+  /** The residual predicate checked on every row read from the table */
+  AbstractExpressionRef filter_predicate_;
+};
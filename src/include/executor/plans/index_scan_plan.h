@@ -2,11 +2,27 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "abstract_plan.h"
 #include "catalog/catalog.h"
 #include "planner/expressions/abstract_expression.h"
 
+/**
+ * The part of a WHERE clause an index answers: equalities on the first key columns, and optionally a range on the
+ * key column after them. The bounds are constant expressions.
+ */
+struct IndexKeyRange {
+  /** The values of the first key columns */
+  std::vector<AbstractExpressionRef> prefix_;
+
+  /** Bounds of the key column after the prefix, nullptr if unbounded */
+  AbstractExpressionRef lower_{nullptr};
+  AbstractExpressionRef upper_{nullptr};
+  bool lower_inclusive_{false};
+  bool upper_inclusive_{false};
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  */
@@ -16,14 +32,20 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_name The identifier of table to be scanned
+   * @param key_ranges The key range to scan of each index
+   * @param filter_predicate The conjuncts of the WHERE clause the key ranges do not answer
+   * @param index_only Whether the index stores every column the output and the filter read
    */
-  IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<IndexInfo *> indexes, bool need_filter,
-                    AbstractExpressionRef filter_predicate = nullptr)
+  IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<IndexInfo *> indexes,
+                    std::vector<IndexKeyRange> key_ranges, bool need_filter,
+                    AbstractExpressionRef filter_predicate = nullptr, bool index_only = false)
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
         indexes_(std::move(indexes)),
+        key_ranges_(std::move(key_ranges)),
         need_filter_(need_filter),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        index_only_(index_only) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::IndexScan; }
@@ -39,9 +61,15 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The indexes*/
   std::vector<IndexInfo *> indexes_;
 
-  /** Whether there are indexes on all columns in the predicate*/
+  /** The key range scanned in each index */
+  std::vector<IndexKeyRange> key_ranges_;
+
+  /** Whether part of the predicate is not answered by the key ranges */
   bool need_filter_ = true;
 
-  /** The predicate to filter in IndexScan.*/
+  /** The residual predicate to filter in IndexScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** Whether rows are made from the index entries alone, without reading the table */
+  bool index_only_ = false;
 };
\ No newline at end of file
@@ -1,14 +1,18 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "index/index_iterator.h"
+#include "index/key_sorter.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
+#include "page/b_plus_tree_posting_page.h"
 #include "transaction/transaction.h"
 
 /**
@@ -16,31 +20,62 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) A unique tree maps a key to one row id. A non-unique tree keeps a key
+ *     once, with the sorted row ids of all its rows: a few in the leaf entry,
+ *     more in a chain of posting pages, see page/b_plus_tree_posting_page.h.
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Thread safe: GetValue, Insert and Remove descend with latch crabbing.
+ *     Insert and Remove first try with read latches down to a write latched
+ *     leaf, and only when the leaf would split or merge descend again holding
+ *     write latches on the part of the path that changes.
+ *     Iterators do not latch, a range scan must not run concurrently with
+ *     writers.
+ * (6) A unique tree may be unique on its first `key_column_count` columns
+ *     only, the rest are included columns stored in the key. Every separator
+ *     above the leaves is then cut after the key columns, so all keys with
+ *     the same key columns route to one leaf and Insert checks them there,
+ *     under the leaf latch.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
   using LeafPage = BPlusTreeLeafPage;
+  friend class BPlusTreeCursor;
 
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
-                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
+                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE, bool unique = true,
+                     uint32_t key_column_count = 0);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree, false if the key (the pair for a non-unique tree) is already there,
+  // or for a unique tree with included columns a key with the same key columns.
   bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all its values from this B+ tree.
   void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one key-value pair from this B+ tree, the key goes with its last value.
+  bool Remove(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key, in row id order
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
 
+  bool IsUnique() const { return value_size_ == sizeof(RowId); }
+
+  /**
+   * Build the tree bottom-up from all entries of `sorter`, which must be finished. Pages are filled left to right to
+   * `fill_factor` of their max size and every page is written once, instead of descending from the root and
+   * splitting pages for every entry. Each level is planned from the number of entries below it, so no page but the
+   * root ends up under its min size.
+   * The tree must be empty.
+   * @return false if two entries of a unique tree have the same key, the tree is left empty then
+   */
+  bool BulkLoad(KeySorter &sorter, double fill_factor = DEFAULT_INDEX_FILL_FACTOR, Transaction *transaction = nullptr);
+
   IndexIterator Begin();
 
   IndexIterator Begin(const GenericKey *key);
@@ -70,7 +105,27 @@ class BPlusTree {
  private:
   void StartNewTree(GenericKey *key, const RowId &value);
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(Page *page, GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  bool RemoveEntry(const GenericKey *key, const RowId *value, Transaction *transaction);
+
+  /**
+   * Remove `value` (every value if nullptr) of `key` from `node` as long as the key keeps a value.
+   * @return the index of the entry to remove as a whole, or -1 if there is nothing more to do
+   */
+  int RemoveValues(LeafPage *node, const GenericKey *key, const RowId *value, bool &removed);
+
+  /** Add `value` to the row ids of entry `index` of a non-unique leaf. @return false if it is already there */
+  bool PostingInsert(LeafPage *node, int index, const RowId &value);
+
+  /** Remove `value` from the row ids of entry `index`, which keeps at least one. @return false if it is not there */
+  bool PostingRemove(LeafPage *node, int index, const RowId &value);
+
+  /** Set the row ids of entry `index` to the sorted `rids`, inline if they fit, else in new posting pages. */
+  void PostingBuild(LeafPage *node, int index, const std::vector<RowId> &rids);
+
+  /** Delete the posting pages of entry `index`, if it has any. */
+  void PostingFree(LeafPage *node, int index);
 
   void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
@@ -96,6 +151,57 @@ class BPlusTree {
 
   void UpdateRootPageId(int insert_record = 0);
 
+  /** How FindLeafPage latches the pages on its way down, see FindLeafPage. */
+  enum class LatchMode { kRead, kOptimistic, kInsert, kRemove };
+
+  Page *FindLeafPage(const GenericKey *key, LatchMode mode, std::vector<Page *> &path, bool &root_locked,
+                     bool leftMost = false);
+
+  void LatchPage(Page *page, LatchMode mode, bool is_leaf);
+
+  /**
+   * Read latched descent for a range scan to the leaf for `key`, the left most leaf if nullptr. The leaf is returned
+   * read latched and pinned, `high_key` gets the separator right of it, i.e. the first key it can not hold.
+   * @return nullptr for an empty tree; `has_high_key` is false for the right most leaf
+   */
+  Page *FindLeafPageForScan(const GenericKey *key, GenericKey *high_key, bool &has_high_key);
+
+  static bool IsSafe(BPlusTreePage *node, LatchMode mode);
+
+  /** @return true if a unique tree can not hold both keys: equal, or with included columns equal key columns */
+  bool IsDuplicate(const GenericKey *lhs, const GenericKey *rhs) const;
+
+  /** Make a copy of the first key of a leaf the separator before it, see (6) above. */
+  void ToSeparator(GenericKey *key) const;
+
+  /** Unlatch and unpin the pages FindLeafPage kept latched, and release root_latch_ if held. */
+  void ReleaseLatches(std::vector<Page *> &path, bool &root_locked, bool write, bool is_dirty);
+
+  /** A level of the tree being built by BulkLoad. */
+  struct BulkLoadLevel {
+    size_t nodes_;                          // pages of this level
+    int base_size_;                         // entries of every page, the first `extra_` pages get one more
+    size_t extra_;
+    std::vector<page_id_t> pages_;          // pages started so far
+    Page *page_{nullptr};                   // page being filled, pinned
+    int quota_{0};                          // entries page_ gets
+  };
+
+  /** Plan a level holding `entries` entries, see BulkLoad. */
+  static BulkLoadLevel PlanLevel(size_t entries, int capacity, int min_size, double fill_factor);
+
+  /** Start the next page of `level` and make it the page being filled. */
+  Page *BulkLoadNewPage(std::vector<BulkLoadLevel> &levels, size_t level);
+
+  /** Append a child to the page being filled at internal `level`. @return the page id of the parent */
+  page_id_t BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, GenericKey *key, page_id_t child);
+
+  /** Append a key with its sorted row ids to the leaf being filled. */
+  void BulkLoadEntry(std::vector<BulkLoadLevel> &levels, GenericKey *key, std::vector<RowId> &rids);
+
+  /** The page being filled at `level` got all its entries: link it into the level above and unpin it. */
+  void BulkLoadComplete(std::vector<BulkLoadLevel> &levels, size_t level);
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -104,10 +210,13 @@ class BPlusTree {
   // member variable
   index_id_t index_id_;
   page_id_t root_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch root_latch_;  // protects root_page_id_
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  int value_size_;  // bytes of a leaf value: a row id, or INDEX_INLINE_POSTING_SIZE of them for a non-unique tree
+  uint32_t key_column_count_;  // columns a unique tree is unique on, 0 for all of them
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
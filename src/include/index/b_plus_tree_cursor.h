@@ -0,0 +1,55 @@
+#ifndef MINISQL_B_PLUS_TREE_CURSOR_H
+#define MINISQL_B_PLUS_TREE_CURSOR_H
+
+#include <vector>
+
+#include "index/b_plus_tree.h"
+#include "index/index.h"
+
+/**
+ * Range cursor over a B+ tree. It reads one leaf at a time under its read latch, buffers the row ids of the keys in
+ * range, and holds no latch or pin between leaves. The next leaf is found by a new descent to the separator right of
+ * the last one, so leaves split or merged meanwhile are neither skipped nor read twice.
+ */
+class BPlusTreeCursor : public IndexCursor {
+ public:
+  /**
+   * Keys are copied, nullptr leaves that side of the range open. With a `key_schema` the cursor keeps the key of each
+   * row id too, for Next(rid, key).
+   */
+  BPlusTreeCursor(BPlusTree *tree, const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                  bool upper_inclusive, Schema *key_schema = nullptr);
+
+  BPlusTreeCursor(const BPlusTreeCursor &) = delete;
+
+  BPlusTreeCursor &operator=(const BPlusTreeCursor &) = delete;
+
+  ~BPlusTreeCursor() override;
+
+  bool Next(RowId &rid) override;
+
+  bool Next(RowId &rid, Row &key) override;
+
+ private:
+  /** Read the next leaf of the range into batch_. @return false if the range has no more row ids */
+  bool FetchBatch();
+
+  /** @return whether `key` is past the upper bound */
+  bool PastUpper(const GenericKey *key) const;
+
+  BPlusTree *tree_;
+  const KeyManager &processor_;
+  GenericKey *upper_{nullptr};
+  bool upper_inclusive_;
+  // where the next leaf starts: the lower bound at first, the separator of the last leaf read after that
+  GenericKey *probe_{nullptr};
+  bool probe_inclusive_;
+  bool done_{false};
+  GenericKey *high_key_;
+  Schema *key_schema_;
+  std::vector<RowId> batch_;
+  std::vector<char> batch_keys_;  // the key of each row id of batch_, with a key schema only
+  size_t batch_index_{0};
+};
+
+#endif  // MINISQL_B_PLUS_TREE_CURSOR_H
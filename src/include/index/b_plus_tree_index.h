@@ -2,12 +2,21 @@
 #define MINISQL_B_PLUS_TREE_INDEX_H
 
 #include "index/b_plus_tree.h"
+#include "index/b_plus_tree_cursor.h"
 #include "index/generic_key.h"
 #include "index/index.h"
+#include "storage/table_heap.h"
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  /**
+   * `key_size` is rounded up to a size with a specialized compare, see KeyManager::FitKeySize.
+   * A non-unique index keeps many rows per key, ScanKey("=") returns all of them.
+   * The last `include_count` columns of the key schema are stored in the tree key after the key columns, ordering
+   * entries of equal key columns; uniqueness and ScanKey look at the key columns only.
+   */
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true, uint32_t include_count = 0);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
@@ -15,8 +24,21 @@ class BPlusTreeIndex : public Index {
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
 
+  /** The range is scanned leaf by leaf as the cursor is pulled, see BPlusTreeCursor. */
+  std::unique_ptr<IndexCursor> OpenCursor(const std::vector<Field> &prefix, const Field *lower, bool lower_inclusive,
+                                          const Field *upper, bool upper_inclusive, Transaction *txn,
+                                          bool with_keys = false) override;
+
   dberr_t Destroy() override;
 
+  /**
+   * Build the (empty) index from all rows of a table, as CREATE INDEX on a populated table does: the keys of one
+   * sequential scan are sorted externally and the tree is built bottom-up, see BPlusTree::BulkLoad.
+   * @return DB_FAILED if two rows of a unique index have the same key, the index is left empty then
+   */
+  dberr_t BulkLoad(TableHeap *table_heap, Schema *table_schema, Transaction *txn,
+                   double fill_factor = DEFAULT_INDEX_FILL_FACTOR);
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
@@ -0,0 +1,185 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_INDEX_H
+#define MINISQL_EXTENDIBLE_HASH_INDEX_H
+
+#include <functional>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "common/rwlatch.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+#include "page/extendible_hash_bucket_page.h"
+#include "page/extendible_hash_directory_page.h"
+
+/**
+ * Yields row ids read when the cursor was opened, as a hash index has no order to resume a scan from.
+ */
+class ExtendibleHashCursor : public IndexCursor {
+ public:
+  /** `keys` holds the key of each row id if the cursor is opened with keys, a `key_schema` is given then. */
+  ExtendibleHashCursor(std::vector<RowId> rids, std::vector<char> keys, const KeyManager &processor,
+                       Schema *key_schema)
+      : rids_(std::move(rids)), keys_(std::move(keys)), processor_(processor), key_schema_(key_schema) {}
+
+  bool Next(RowId &rid) override {
+    if (next_ == rids_.size()) {
+      return false;
+    }
+    rid = rids_[next_++];
+    return true;
+  }
+
+  bool Next(RowId &rid, Row &key) override {
+    ASSERT(key_schema_ != nullptr, "Cursor opened without keys.");
+    if (!Next(rid)) {
+      return false;
+    }
+    key.destroy();
+    processor_.DeserializeToKey(
+        reinterpret_cast<const GenericKey *>(keys_.data() + (next_ - 1) * processor_.GetKeySize()), key, key_schema_);
+    key.SetRowId(rid);
+    return true;
+  }
+
+ private:
+  std::vector<RowId> rids_;
+  std::vector<char> keys_;
+  const KeyManager &processor_;
+  Schema *key_schema_;
+  size_t next_{0};
+};
+
+/**
+ * The directory of an ExtendibleHashIndex over its directory pages, see ExtendibleHashDirectoryPage. Slots are
+ * numbered across the pages. The first page is pinned while the object lives, the others once their slots are used,
+ * and the destructor unpins them all.
+ */
+class ExtendibleHashDirectory {
+ public:
+  ExtendibleHashDirectory(BufferPoolManager *buffer_pool_manager, page_id_t page_id);
+
+  ~ExtendibleHashDirectory();
+
+  DISALLOW_COPY_AND_MOVE(ExtendibleHashDirectory);
+
+  inline uint32_t GetGlobalDepth() const { return pages_[0]->GetGlobalDepth(); }
+
+  inline uint32_t Size() const { return 1U << GetGlobalDepth(); }
+
+  /** @return the slot of a key with `hash` */
+  inline uint32_t HashToSlot(uint64_t hash) const { return static_cast<uint32_t>(hash) & (Size() - 1); }
+
+  page_id_t GetBucketPageId(uint32_t slot);
+
+  void SetBucketPageId(uint32_t slot, page_id_t bucket_page_id);
+
+  uint32_t GetLocalDepth(uint32_t slot);
+
+  void SetLocalDepth(uint32_t slot, uint32_t local_depth);
+
+  /** @return the slot whose bucket splits off from, or merges into, the bucket of `slot` at its local depth */
+  inline uint32_t GetSplitImageSlot(uint32_t slot) { return slot ^ (1U << (GetLocalDepth(slot) - 1)); }
+
+  /** Double the directory, the new upper half refers to the same buckets as the lower half. */
+  void IncrGlobalDepth();
+
+  /** Halve the directory, only if CanShrink. */
+  void DecrGlobalDepth();
+
+  /** @return whether no bucket has a local depth of the global depth */
+  bool CanShrink();
+
+  /** Delete all directory pages, the buckets are not freed. */
+  void Destroy();
+
+ private:
+  /** @return the directory page of `slot`, pinned; marked dirty if `dirty` */
+  HashDirectoryPage *PageOf(uint32_t slot, bool dirty = false);
+
+  BufferPoolManager *buffer_pool_manager_;
+  /** The directory pages in order, nullptr for those not pinned yet */
+  std::vector<HashDirectoryPage *> pages_;
+  std::vector<bool> dirty_;
+};
+
+/**
+ * A disk based extendible hash index (CREATE INDEX ... USING hash). An equality lookup on the whole key reads a
+ * directory page, two once the directory outgrows its first page, and one bucket page, instead of a page per level of
+ * a B+ tree. Buckets split as they fill, doubling the directory when needed, and merge with their split image
+ * when emptied, see ExtendibleHashDirectoryPage.
+ *
+ * Any other scan has to read every bucket, and returns the rows in no particular order. The planner only picks a
+ * hash index for `=` on all of its key columns.
+ *
+ * The directory page id is kept in the index roots page, like the root of a B+ tree. Operations are serialized by a
+ * latch of the index, shared by lookups.
+ */
+class ExtendibleHashIndex : public Index {
+ public:
+  /**
+   * `key_size` is rounded up to a size with a specialized compare, see KeyManager::FitKeySize.
+   * A non-unique index keeps many rows per key, ScanKey("=") returns all of them.
+   */
+  ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                      BufferPoolManager *buffer_pool_manager, bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  /** The rows are read when the cursor is opened, by one bucket lookup if `prefix` is the whole key. */
+  std::unique_ptr<IndexCursor> OpenCursor(const std::vector<Field> &prefix, const Field *lower, bool lower_inclusive,
+                                          const Field *upper, bool upper_inclusive, Transaction *txn,
+                                          bool with_keys = false) override;
+
+  /** Free all pages of the index. */
+  dberr_t Destroy() override;
+
+  /** @return the global depth of the directory, 0 for an empty index */
+  uint32_t GetGlobalDepth();
+
+ private:
+  /** @return false if the key is in a unique index already, or the pair is in a non-unique one */
+  bool Insert(const GenericKey *key, const RowId &value);
+
+  /** @return false if the pair is not in the index */
+  bool Remove(const GenericKey *key, const RowId &value);
+
+  /** Append the row ids of `key` to `result`. */
+  void GetValue(const GenericKey *key, std::vector<RowId> &result);
+
+  /** Append the row ids of all keys for which `match` holds to `result`, and the keys to `keys` if given. */
+  void Scan(const std::function<bool(const GenericKey *)> &match, std::vector<RowId> &result,
+            std::vector<char> *keys = nullptr);
+
+  /**
+   * @return whether the full bucket of the slot should split, rather than grow an overflow page. A bucket found to
+   * hold mostly one hash records the size of its chain, see HashBucketPage::GetHotSize.
+   */
+  bool CanSplit(ExtendibleHashDirectory &directory, uint32_t slot);
+
+  /** Split the bucket of the slot by the next hash bit, the directory grows if the bucket is at global depth. */
+  void SplitBucket(ExtendibleHashDirectory &directory, uint32_t slot);
+
+  /** Merge the empty bucket of the slot into its split image while that can be done, then shrink the directory. */
+  void MergeBucket(ExtendibleHashDirectory &directory, uint32_t slot);
+
+  /** Insert into the first page of the chain with room, a new overflow page if none has. */
+  void AppendToChain(HashBucketPage *head, const GenericKey *key, const RowId &value);
+
+  /** Delete the pages of the chain starting with `page_id`. */
+  void FreeChain(page_id_t page_id);
+
+  /** Record directory_page_id_ in the index roots page. */
+  void UpdateRootPageId(bool insert_record);
+
+  KeyManager processor_;
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t directory_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch latch_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_INDEX_H
@@ -1,16 +1,52 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "record/field.h"
 #include "record/row.h"
 
+/**
+ * An index key in a normalized, order preserving format: for every key column a null byte (0 for null, 1 otherwise)
+ * followed by the value as written by Field::SerializeToKey, and zero bytes up to the key size. Two keys compare like
+ * their rows, nulls first, by comparing their bytes with memcmp.
+ */
 class GenericKey {
   friend class KeyManager;
   char data[0];
 };
 
+/**
+ * Key sizes whose compare is specialized at compile time. An index rounds its key size up to the smallest of them
+ * that fits (KeyManager::FitKeySize), so e.g. a key on one int or float column, 5 bytes, compares as a single 8 byte
+ * integer.
+ */
+static constexpr size_t GENERIC_KEY_SIZES[] = {8, 16, 32, 64, 128, 256};
+
+/**
+ * memcmp of two N byte keys, 8 bytes at a time: loaded as big-endian integers, 8 bytes compare like they do in
+ * memcmp. N must be a multiple of 8.
+ */
+template <size_t N>
+inline int CompareGenericKeys(const char *lhs, const char *rhs) {
+  static_assert(N % sizeof(uint64_t) == 0, "Key size must be a multiple of 8.");
+  for (size_t i = 0; i < N; i += sizeof(uint64_t)) {
+    uint64_t l, r;
+    memcpy(&l, lhs + i, sizeof(uint64_t));
+    memcpy(&r, rhs + i, sizeof(uint64_t));
+    if (l != r) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      l = __builtin_bswap64(l);
+      r = __builtin_bswap64(r);
+#endif
+      return l < r ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,54 +54,206 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    char *buf = key_buf->data;
+    for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+      Field *field = key.GetField(i);
+      if (field->IsNull()) {
+        ASSERT(buf + 1 <= key_buf->data + key_size_, "Index key size exceed max key size.");
+        *buf++ = KEY_NULL;
+        continue;
+      }
+      ASSERT(buf + 1 + field->GetKeySerializedSize() <= key_buf->data + key_size_, "Index key size exceed max key size.");
+      *buf++ = KEY_NOT_NULL;
+      buf += field->SerializeToKey(buf);
+    }
+  }
+
+  /**
+   * Serialize the first `column_count` fields of `key` like SerializeFromKey, and set the rest of the key to `fill`.
+   * Filled with KEY_FILL_LOW and KEY_FILL_HIGH, the keys bound all keys with those first columns.
+   */
+  inline void SerializeFromKey(GenericKey *key_buf, const Row &key, uint32_t column_count, char fill) const {
+    memset(key_buf->data, fill, key_size_);
+    char *buf = key_buf->data;
+    for (uint32_t i = 0; i < column_count; i++) {
+      Field *field = key.GetField(i);
+      ASSERT(buf + 1 + (field->IsNull() ? 0 : field->GetKeySerializedSize()) <= key_buf->data + key_size_,
+             "Index key size exceed max key size.");
+      if (field->IsNull()) {
+        *buf++ = KEY_NULL;
+        continue;
+      }
+      *buf++ = KEY_NOT_NULL;
+      buf += field->SerializeToKey(buf);
+    }
+  }
+
+  /**
+   * Serialize a bound for the keys whose first columns hold the values of `prefix`, the rest of the key is set to
+   * `fill`. Filled with KEY_FILL_LOW the bound is not greater than any key starting with the prefix, filled with
+   * KEY_FILL_HIGH it is greater than all of them. With `skip_null` the column after the prefix gets its not-null byte,
+   * then a KEY_FILL_LOW bound sits right after the keys where that column is null.
+   */
+  inline void SerializePrefixToKey(GenericKey *key_buf, const std::vector<Field> &prefix, char fill,
+                                   bool skip_null = false) const {
+    memset(key_buf->data, fill, key_size_);
+    char *buf = key_buf->data;
+    for (auto &field : prefix) {
+      ASSERT(!field.IsNull(), "Index key prefix must not be null.");
+      ASSERT(buf + 1 + field.GetKeySerializedSize() <= key_buf->data + key_size_, "Index key size exceed max key size.");
+      *buf++ = KEY_NOT_NULL;
+      buf += field.SerializeToKey(buf);
+    }
+    if (skip_null && buf < key_buf->data + key_size_) {
+      *buf = KEY_NOT_NULL;
+    }
+  }
+
+  /**
+   * Serialize the bounds of the keys that start with the values of `prefix` and whose next column is above `lower`
+   * and below `upper` (or equal with the inclusive flag), if given, to the range from `low` (inclusive) to `high`
+   * (exclusive). Keys where the column after the prefix is null are out of a range with a bound.
+   */
+  inline void SerializeRangeToKeys(GenericKey *low, GenericKey *high, const std::vector<Field> &prefix,
+                                   const Field *lower, bool lower_inclusive, const Field *upper,
+                                   bool upper_inclusive) const {
+    std::vector<Field> bound(prefix);
+    if (lower != nullptr) {
+      bound.emplace_back(*lower);
+      SerializePrefixToKey(low, bound, lower_inclusive ? KEY_FILL_LOW : KEY_FILL_HIGH);
+      bound.pop_back();
+    } else {
+      SerializePrefixToKey(low, bound, KEY_FILL_LOW, upper != nullptr);
+    }
+    if (upper != nullptr) {
+      bound.emplace_back(*upper);
+      SerializePrefixToKey(high, bound, upper_inclusive ? KEY_FILL_HIGH : KEY_FILL_LOW);
+    } else {
+      SerializePrefixToKey(high, bound, KEY_FILL_HIGH);
+    }
   }
 
   inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    char *buf = const_cast<char *>(key_buf->data);
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      TypeId type = schema->GetColumn(i)->GetType();
+      Field *field = nullptr;
+      if (*buf++ == KEY_NULL) {
+        field = new Field(type);
+      } else {
+        buf += Field::DeserializeFromKey(buf, type, &field);
+      }
+      key.GetFields().push_back(field);
+    }
+    ASSERT(buf <= key_buf->data + key_size_, "Index key size exceed max key size.");
+  }
+
+  /** @return the bytes SerializeFromKey wrote for the first `column_count` columns of `key_buf` */
+  inline uint32_t GetPrefixSize(const GenericKey *key_buf, uint32_t column_count) const {
+    char *buf = const_cast<char *>(key_buf->data);
+    for (uint32_t i = 0; i < column_count; i++) {
+      if (*buf++ == KEY_NULL) {
+        continue;
+      }
+      Field *field = nullptr;
+      buf += Field::DeserializeFromKey(buf, key_schema_->GetColumn(i)->GetType(), &field);
+      delete field;
+    }
+    ASSERT(buf <= key_buf->data + key_size_, "Index key size exceed max key size.");
+    return buf - key_buf->data;
+  }
+
+  /**
+   * @return true if the first `column_count` columns of the keys hold the same values. No column encoding is a prefix
+   * of another, so the bytes of those columns in `lhs` are enough to compare.
+   */
+  [[nodiscard]] inline bool ComparePrefixEquals(const GenericKey *lhs, const GenericKey *rhs,
+                                                uint32_t column_count) const {
+    return memcmp(lhs->data, rhs->data, GetPrefixSize(lhs, column_count)) == 0;
+  }
+
+  /** Set everything after the first `column_count` columns of `key_buf` to KEY_FILL_LOW, the least key of the prefix. */
+  inline void TruncateToPrefix(GenericKey *key_buf, uint32_t column_count) const {
+    uint32_t size = GetPrefixSize(key_buf, column_count);
+    memset(key_buf->data + size, KEY_FILL_LOW, key_size_ - size);
   }
 
   // compare
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
+    switch (key_size_) {
+      case 8:
+        return CompareGenericKeys<8>(lhs->data, rhs->data);
+      case 16:
+        return CompareGenericKeys<16>(lhs->data, rhs->data);
+      case 32:
+        return CompareGenericKeys<32>(lhs->data, rhs->data);
+      case 64:
+        return CompareGenericKeys<64>(lhs->data, rhs->data);
+      case 128:
+        return CompareGenericKeys<128>(lhs->data, rhs->data);
+      case 256:
+        return CompareGenericKeys<256>(lhs->data, rhs->data);
+      default:
+        break;
+    }
+    int cmp = memcmp(lhs->data, rhs->data, key_size_);
+    return (cmp > 0) - (cmp < 0);
+  }
 
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
+  /** @return a hash of the key bytes (64 bit FNV-1a), equal keys hash alike */
+  [[nodiscard]] inline uint64_t HashKey(const GenericKey *key) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < key_size_; i++) {
+      hash ^= static_cast<uint8_t>(key->data[i]);
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
 
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        if (key_schema_->GetColumn(i)->GetType() == kTypeChar) {
-          delete lhs_value->GetData();
-          delete rhs_value->GetData();
+  /**
+   * @return the largest key SerializeFromKey can write for `key_schema`: a null byte per column, and for a char column
+   * the encoding of a value of 0x00 bytes only, each of them escaped, with its terminator
+   */
+  static size_t GetMaxKeySize(const Schema *key_schema) {
+    size_t key_size = 0;
+    for (auto column : key_schema->GetColumns()) {
+      key_size += sizeof(KEY_NOT_NULL);
+      switch (column->GetType()) {
+        case TypeId::kTypeInt:
+          key_size += Field(TypeId::kTypeInt, 0).GetKeySerializedSize();
+          break;
+        case TypeId::kTypeFloat:
+          key_size += Field(TypeId::kTypeFloat, 0.0f).GetKeySerializedSize();
+          break;
+        case TypeId::kTypeChar: {
+          std::vector<char> zeros(column->GetLength(), '\0');
+          key_size += Field(TypeId::kTypeChar, zeros.data(), zeros.size(), false).GetKeySerializedSize();
+          break;
         }
-        return -1;
+        default:
+          ASSERT(false, "Unsupported key column type.");
       }
+    }
+    return key_size;
+  }
 
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        if (key_schema_->GetColumn(i)->GetType() == kTypeChar) {
-          delete lhs_value->GetData();
-          delete rhs_value->GetData();
-        }
-        return 1;
+  /** @return the smallest of GENERIC_KEY_SIZES that holds `key_size` bytes, `key_size` itself if none does */
+  static size_t FitKeySize(size_t key_size) {
+    for (auto size : GENERIC_KEY_SIZES) {
+      if (key_size <= size) {
+        return size;
       }
     }
-    // equals
-    return 0;
+    return key_size;
   }
 
   inline int GetKeySize() const { return key_size_; }
 
+  static constexpr char KEY_FILL_LOW = 0;
+  static constexpr char KEY_FILL_HIGH = static_cast<char>(0xFF);
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
@@ -75,6 +263,9 @@ class KeyManager {
   KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
 
  private:
+  static constexpr char KEY_NULL = 0;
+  static constexpr char KEY_NOT_NULL = 1;
+
   int key_size_;
   Schema *key_schema_;
 };
@@ -2,14 +2,34 @@
 #define MINISQL_INDEX_H
 
 #include <memory>
+#include <vector>
 
 #include "common/dberr.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
+/**
+ * Yields the row ids of an index range one at a time, reading the index only as far as the caller pulls.
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  /** @return false once the range is exhausted, `rid` is left unchanged then */
+  virtual bool Next(RowId &rid) = 0;
+
+  /** Like Next(rid), and set `key` to the columns stored in the index entry. The cursor must be opened with keys. */
+  virtual bool Next(RowId &rid, Row &key) = 0;
+};
+
 class Index {
  public:
-  explicit Index(index_id_t index_id, IndexSchema *key_schema) : index_id_(index_id), key_schema_(key_schema) {}
+  /**
+   * The last `include_count` columns of `key_schema` are included columns, see IndexMetadata::GetIncludeMapping.
+   * A unique index rejects a second row with the same key columns.
+   */
+  explicit Index(index_id_t index_id, IndexSchema *key_schema, uint32_t include_count = 0, bool unique = true)
+      : index_id_(index_id), key_schema_(key_schema), include_count_(include_count), unique_(unique) {}
 
   virtual ~Index() {}
 
@@ -20,11 +40,41 @@ class Index {
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
                           string compare_operator = "=") = 0;
 
+  /**
+   * Open a cursor over the rows whose key starts with the values of `prefix`, in key order if the index is ordered.
+   * If `lower` or `upper` is given the key column after the prefix must also be above `lower` and below `upper`, or
+   * equal with the inclusive flag set. Rows where that column is null match no bound.
+   * With `with_keys` the cursor also returns the stored columns of each entry, for an index-only scan.
+   */
+  virtual std::unique_ptr<IndexCursor> OpenCursor(const std::vector<Field> &prefix, const Field *lower,
+                                                  bool lower_inclusive, const Field *upper, bool upper_inclusive,
+                                                  Transaction *txn, bool with_keys = false) = 0;
+
+  /** Append all rows of OpenCursor(prefix, lower, ...) to `result`. */
+  dberr_t ScanPrefix(const std::vector<Field> &prefix, const Field *lower, bool lower_inclusive, const Field *upper,
+                     bool upper_inclusive, std::vector<RowId> &result, Transaction *txn) {
+    auto cursor = OpenCursor(prefix, lower, lower_inclusive, upper, upper_inclusive, txn);
+    size_t old_size = result.size();
+    RowId rid;
+    while (cursor->Next(rid)) {
+      result.emplace_back(rid);
+    }
+    return result.size() > old_size ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+  }
+
   virtual dberr_t Destroy() = 0;
 
+  /** @return number of key columns, the leading columns of the key schema */
+  uint32_t GetKeyColumnCount() const { return key_schema_->GetColumnCount() - include_count_; }
+
+  /** @return whether the key columns are unique, a non-unique index keeps many rows per key */
+  bool IsUnique() const { return unique_; }
+
  protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
+  uint32_t include_count_;
+  bool unique_;
 };
 
 #endif  // MINISQL_INDEX_H
@@ -1,8 +1,14 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
+/**
+ * Iterates the key/value pairs of a B+ tree in key order. On a non-unique tree a key comes once per row id, in row
+ * id order.
+ */
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage;
 
@@ -33,6 +39,11 @@ class IndexIterator {
   BufferPoolManager *buffer_pool_manager{nullptr};
   // add your own private member variables here
   LeafPage *node;
+  std::vector<RowId> postings_;  // row ids of the key at item_index on a non-unique tree
+  size_t posting_index_{0};
+
+  /** Read the row ids of the key at item_index into postings_, if the tree is non-unique. */
+  void LoadPostings();
 };
 
 #endif  // MINISQL_INDEX_ITERATOR_H
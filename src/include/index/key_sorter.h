@@ -0,0 +1,93 @@
+#ifndef MINISQL_KEY_SORTER_H
+#define MINISQL_KEY_SORTER_H
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * KeySorter sorts the (key, row id) entries of an index build so that BPlusTree::BulkLoad can consume them in key
+ * order.
+ *
+ * Entries are collected in a memory buffer of at most `memory_budget` bytes. Whenever it is full the buffer is sorted
+ * and written to a temporary file as one sorted run. Finish() sorts what is left in memory, and Next() then returns
+ * the entries in key order, merging the runs on the fly. A build that fits in memory never touches a file.
+ *
+ * Usage: Add() every entry, call Finish() once, then call Next() until it returns false.
+ */
+class KeySorter {
+ public:
+  explicit KeySorter(const KeyManager &KM, size_t memory_budget = INDEX_BUILD_SORT_MEMORY);
+
+  ~KeySorter();
+
+  /** Add one entry. The key is copied. Must not be called after Finish(). */
+  void Add(const GenericKey *key, const RowId &rid);
+
+  /** Sort the entries still in memory and prepare the merge of all runs. */
+  void Finish();
+
+  /**
+   * Return the next entry in key order.
+   * @param[out] key points into the sorter's memory, valid until the next call to Next()
+   * @return false when all entries have been returned
+   */
+  bool Next(GenericKey *&key, RowId &rid);
+
+  /**
+   * Count the distinct keys with one pass over the sorted entries, then start Next() over from the first entry.
+   * Must be called after Finish() and before the first Next().
+   */
+  size_t CountKeys();
+
+  /** @return number of entries added */
+  inline size_t GetCount() const { return count_; }
+
+  /** @return number of sorted runs spilled to temporary files */
+  inline size_t GetRunCount() const { return runs_.size(); }
+
+ private:
+  /** A sorted run on disk and the block of it currently buffered for the merge. */
+  struct Run {
+    FILE *file_{nullptr};
+    std::unique_ptr<char[]> block_;
+    size_t block_entries_{0};  // entries in block_
+    size_t pos_{0};            // index of the current entry in block_
+  };
+
+  inline char *EntryAt(char *base, size_t index) const { return base + index * entry_size_; }
+
+  /** Sort the entries in memory by key, leaving the order in order_. */
+  void SortBuffer();
+
+  /** Write the sorted entries in memory to a new run and empty the buffer. */
+  void SpillRun();
+
+  /** Start the merge of the runs from their first entries. */
+  void Rewind();
+
+  /** Read the next block of a run, @return false if the run is exhausted */
+  bool FillBlock(Run &run);
+
+  /** Heap order for the merge: the run with the smallest current key at the top. */
+  bool RunGreater(size_t lhs, size_t rhs);
+
+  KeyManager processor_;
+  size_t entry_size_;        // key size + sizeof(RowId)
+  size_t buffer_capacity_;   // entries that fit in buffer_
+  size_t buffer_entries_{0};
+  std::unique_ptr<char[]> buffer_;
+  std::vector<uint32_t> order_;  // sorted positions of the entries in buffer_
+  size_t next_{0};               // entries returned so far
+  size_t count_{0};
+  bool finished_{false};
+  std::vector<Run> runs_;
+  std::vector<size_t> merge_heap_;  // runs that still have entries, as a heap ordered by RunGreater
+  size_t block_entries_{0};         // entries read from a run at a time during the merge
+};
+
+#endif  // MINISQL_KEY_SORTER_H
@@ -9,7 +9,12 @@
 #include "page/b_plus_tree_page.h"
 
 #define INTERNAL_PAGE_HEADER_SIZE 28
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(std::pair<GenericKey *, page_id_t>)) - 1)
+
+/** Max size of an internal page with keys of `key_size` bytes, one pair is left free for the insert that splits it. */
+constexpr int InternalPageMaxSize(int key_size) {
+  return (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (key_size + sizeof(page_id_t)) - 1;
+}
+
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
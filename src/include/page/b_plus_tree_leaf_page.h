@@ -6,20 +6,22 @@
  *
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. A key is stored once: the value of a unique tree is the row id, the
+ * value of a non-unique tree holds the row ids of the key, see
+ * page/b_plus_tree_posting_page.h.
 
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | ValueSize (4)
+ *  ------------------------------------------------------------
  */
 #include <utility>
 #include <vector>
@@ -27,29 +29,39 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
-#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)) - 1)
+#define LEAF_PAGE_HEADER_SIZE 36
+
+/** Max size of a leaf page with keys of `key_size` bytes, one pair is left free for the insert that splits it. */
+constexpr int LeafPageMaxSize(int key_size, int value_size = sizeof(RowId)) {
+  return (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (key_size + value_size) - 1;
+}
 
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
-            int max_size = UNDEFINED_SIZE);
+            int max_size = UNDEFINED_SIZE, int value_size = sizeof(RowId));
 
   // helper methods
   page_id_t GetNextPageId() const;
 
   void SetNextPageId(page_id_t next_page_id);
 
+  int GetValueSize() const;
+
   GenericKey *KeyAt(int index);
 
   void SetKeyAt(int index, GenericKey *key);
 
   RowId ValueAt(int index) const;
 
+  // sets the first row id of the value, the other row ids of a non-unique value to INVALID_ROWID
   void SetValueAt(int index, RowId value);
 
+  // the row ids of the value of kvp[index], GetValueSize() / sizeof(RowId) of them
+  RowId *ValuesAt(int index);
+
   int KeyIndex(const GenericKey *key, const KeyManager &comparator);
 
   void *PairPtrAt(int index);
@@ -79,11 +91,12 @@ class BPlusTreeLeafPage : public BPlusTreePage {
  private:
   void CopyNFrom(void *src, int size);
 
-  void CopyLastFrom(GenericKey *key, const RowId value);
+  void CopyLastFrom(void *pair);
 
-  void CopyFirstFrom(GenericKey *key, const RowId value);
+  void CopyFirstFrom(void *pair);
 
   page_id_t next_page_id_{INVALID_PAGE_ID};
+  int value_size_{sizeof(RowId)};
 
   char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE]; // 该 Page 剩余的部分用来存键值对 pair<KeyType, ValueType>
 };
@@ -0,0 +1,86 @@
+#ifndef MINISQL_B_PLUS_TREE_POSTING_PAGE_H
+#define MINISQL_B_PLUS_TREE_POSTING_PAGE_H
+
+/**
+ * b_plus_tree_posting_page.h
+ *
+ * A leaf entry of a non-unique B+ tree keeps the row ids of its key in a value
+ * of INDEX_INLINE_POSTING_SIZE row ids, sorted, unused slots INVALID_ROWID.
+ * When a key has more rows than that, the row ids move to a chain of posting
+ * pages, sorted across the chain, and the value refers to the chain instead:
+ *  ----------------------------------------------------------------------------------
+ * | (FirstPageId, POSTING_LIST_SLOT) | (LastPageId, RowIdCount) | INVALID_ROWID ... |
+ *  ----------------------------------------------------------------------------------
+ * Posting pages are changed only under the write latch of the leaf holding the
+ * key, so they have no latching of their own.
+ *
+ * Posting page format (row ids are stored in order):
+ *  ---------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | Size (4) | RID(1) | RID(2) | ... | RID(n)
+ *  ---------------------------------------------------------------------
+ */
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rowid.h"
+
+#define POSTING_PAGE_HEADER_SIZE 12
+
+/** Slot number of the first row id of a value that refers to posting pages, never a slot of a table page. */
+static constexpr uint32_t POSTING_LIST_SLOT = UINT32_MAX;
+
+static_assert(INDEX_INLINE_POSTING_SIZE >= 2, "A posting list reference takes two row ids.");
+
+class BPlusTreePostingPage {
+ public:
+  static constexpr int MAX_SIZE = (PAGE_SIZE - POSTING_PAGE_HEADER_SIZE) / sizeof(RowId);
+
+  void Init(page_id_t page_id);
+
+  inline page_id_t GetPageId() const { return page_id_; }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  inline int GetSize() const { return size_; }
+
+  inline bool IsFull() const { return size_ == MAX_SIZE; }
+
+  inline RowId RowIdAt(int index) const { return rids_[index]; }
+
+  /** @return the first index whose row id is not less than `rid` */
+  int RowIdIndex(const RowId &rid) const;
+
+  /** Insert `rid` in order, the page must not be full. @return false if it is already there */
+  bool Insert(const RowId &rid);
+
+  /** @return false if `rid` is not there */
+  bool Remove(const RowId &rid);
+
+  /** Append `count` row ids, larger than all row ids of this page, in order. */
+  void Append(const RowId *rids, int count);
+
+  /** Move the upper half of the row ids to the empty page `recipient`. */
+  void MoveHalfTo(BPlusTreePostingPage *recipient);
+
+  /** @return whether the value of a leaf entry refers to posting pages */
+  static inline bool IsPostingList(const RowId *value) {
+    return value[0].GetSlotNum() == POSTING_LIST_SLOT && value[0].GetPageId() != INVALID_PAGE_ID;
+  }
+
+  /** @return number of row ids of the value of a leaf entry with `slots` row ids */
+  static int RowIdCount(const RowId *value, int slots);
+
+  /** Append the row ids of the value of a leaf entry to `result`, in order. */
+  static void CollectRowIds(const RowId *value, int slots, BufferPoolManager *bpm, std::vector<RowId> &result);
+
+ private:
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int size_;
+  RowId rids_[0];
+};
+
+using PostingPage = BPlusTreePostingPage;
+#endif  // MINISQL_B_PLUS_TREE_POSTING_PAGE_H
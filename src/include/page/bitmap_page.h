@@ -20,6 +20,12 @@ class BitmapPage {
    */
   bool AllocatePage(uint32_t &page_offset);
 
+  /**
+   * Allocate one specific page of the extent.
+   * @return false if it is out of range or in use
+   */
+  bool AllocatePageAt(uint32_t page_offset);
+
   /**
    * @return true if successfully de-allocate a page.
    */
@@ -30,6 +36,12 @@ class BitmapPage {
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * Find the first free page in [from, to) a 64-bit word at a time.
+   * @return true if one was found
+   */
+  bool FindFreePage(uint32_t from, uint32_t to, uint32_t &page_offset) const;
+
  private:
   /**
    * check a bit(byte_index, bit_index) in bytes is free(value 0).
@@ -42,6 +54,7 @@ class BitmapPage {
 
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "Bitmap is scanned in 64-bit words.");
 
  private:
   /** The space occupied by all members of the class should be equal to the PageSize */
@@ -2,11 +2,16 @@
 #define MINISQL_DISK_FILE_META_PAGE_H
 
 #include <cstdint>
+#include <limits>
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+// logical page ids are only limited by page_id_t, files grow past one meta page in groups, see DiskManager
+static constexpr page_id_t MAX_VALID_PAGE_ID = std::numeric_limits<page_id_t>::max();
 
+/**
+ * Usage of the extents of one group. The counters cover this group only.
+ */
 class DiskFileMetaPage {
  public:
   uint32_t GetExtentNums() { return num_extents_; }
@@ -0,0 +1,88 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_BUCKET_PAGE_H
+#define MINISQL_EXTENDIBLE_HASH_BUCKET_PAGE_H
+
+/**
+ * extendible_hash_bucket_page.h
+ *
+ * A bucket of an extendible hash index keeps unordered (key, row id) pairs. A
+ * non-unique index keeps one pair per row. A full bucket page splits, unless
+ * most of its keys hash alike (a hot key of a non-unique index) or its local
+ * depth is HASH_DIRECTORY_MAX_DEPTH: then the bucket grows a chain of overflow
+ * pages of the same format, linked by NextPageId. A bucket with a chain still
+ * splits, chain and all, as soon as its keys no longer mostly hash alike.
+ *
+ * Bucket page format:
+ *  --------------------------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | Size (4) | KeySize (4) | HotSize (4) | KEY(1)+RID(1) | ... |
+ *  --------------------------------------------------------------------------------------------
+ */
+#include <vector>
+
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+#define HASH_BUCKET_PAGE_HEADER_SIZE 20
+
+class ExtendibleHashBucketPage {
+ public:
+  void Init(page_id_t page_id, int key_size);
+
+  inline page_id_t GetPageId() const { return page_id_; }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  inline int GetSize() const { return size_; }
+
+  inline int GetMaxSize() const { return MaxSize(key_size_); }
+
+  inline bool IsFull() const { return size_ == GetMaxSize(); }
+
+  /**
+   * On the head page of a chain: the number of pairs in the chain when its keys were last found to mostly hash alike,
+   * 0 if never. The chain is not checked again before it has twice as many.
+   */
+  inline int GetHotSize() const { return hot_size_; }
+
+  inline void SetHotSize(int hot_size) { hot_size_ = hot_size; }
+
+  inline GenericKey *KeyAt(int index) { return reinterpret_cast<GenericKey *>(PairPtrAt(index)); }
+
+  RowId ValueAt(int index) const;
+
+  /** @return the index of the pair (`key`, `value`), or of any pair of `key` if `value` is nullptr; -1 if none */
+  int Find(const GenericKey *key, const RowId *value, const KeyManager &KM);
+
+  /** Append the row ids of `key` to `result`. */
+  void GetValue(const GenericKey *key, const KeyManager &KM, std::vector<RowId> &result);
+
+  /** Add a pair, the page must not be full. */
+  void Insert(const GenericKey *key, const RowId &value);
+
+  /** Remove the pair at `index`, the last pair takes its place. */
+  void RemoveAt(int index);
+
+  /** Take the pairs and the next page of the overflow page `next`, this page must be empty. */
+  void MoveAllFrom(ExtendibleHashBucketPage *next);
+
+  /** @return how many pairs of keys of `key_size` bytes fit in a page */
+  static int MaxSize(int key_size) {
+    return (PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE) / (key_size + static_cast<int>(sizeof(RowId)));
+  }
+
+ private:
+  inline char *PairPtrAt(int index) { return pairs_ + index * (key_size_ + sizeof(RowId)); }
+
+  inline const char *PairPtrAt(int index) const { return pairs_ + index * (key_size_ + sizeof(RowId)); }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int size_;
+  int key_size_;
+  int hot_size_;
+  char pairs_[0];
+};
+
+using HashBucketPage = ExtendibleHashBucketPage;
+#endif  // MINISQL_EXTENDIBLE_HASH_BUCKET_PAGE_H
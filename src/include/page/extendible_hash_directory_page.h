@@ -0,0 +1,81 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_DIRECTORY_PAGE_H
+#define MINISQL_EXTENDIBLE_HASH_DIRECTORY_PAGE_H
+
+/**
+ * extendible_hash_directory_page.h
+ *
+ * The directory of an extendible hash index. Slot i of the directory refers to
+ * the bucket of the keys whose hash ends with the low GlobalDepth bits of i.
+ * A bucket with local depth d is shared by the 2^(GlobalDepth - d) slots that
+ * agree on the low d bits.
+ *
+ * The slots are kept on directory pages of SLOTS_PER_PAGE slots each, slot i on
+ * directory page i / SLOTS_PER_PAGE. The first directory page also keeps the
+ * global depth and the page ids of all directory pages, the others keep only
+ * their slots. A directory of up to SLOTS_PER_PAGE slots is that first page
+ * alone; growing past it, each doubling adds as many pages as it has.
+ *
+ * Directory page format:
+ *  --------------------------------------------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | LocalDepth (1) x SLOTS | BucketPageId (4) x SLOTS | DirPageId (4) x MAX_PAGES |
+ *  --------------------------------------------------------------------------------------------------------------
+ */
+#include <cstdint>
+
+#include "common/config.h"
+
+/** The slots of one directory page, 2^HASH_DIRECTORY_PAGE_DEPTH. */
+#define HASH_DIRECTORY_PAGE_DEPTH 9
+
+/** The directory has at most 2^HASH_DIRECTORY_MAX_DEPTH slots, as many as the first page can list the pages of. */
+#define HASH_DIRECTORY_MAX_DEPTH 17
+
+class ExtendibleHashDirectoryPage {
+ public:
+  static constexpr uint32_t SLOTS_PER_PAGE = 1 << HASH_DIRECTORY_PAGE_DEPTH;
+  static constexpr uint32_t MAX_PAGES = 1 << (HASH_DIRECTORY_MAX_DEPTH - HASH_DIRECTORY_PAGE_DEPTH);
+
+  /** Init the first page of a directory of one slot, referring to `bucket_page_id`. */
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  /** Init a further page of a directory, its slots are set by the directory. */
+  void Init(page_id_t page_id);
+
+  inline page_id_t GetPageId() const { return page_id_; }
+
+  /** Kept on the first page only. */
+  inline uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  inline void SetGlobalDepth(uint32_t global_depth) { global_depth_ = global_depth; }
+
+  /** @return the id of directory page `index`, kept on the first page only */
+  inline page_id_t GetDirectoryPageId(uint32_t index) const { return directory_page_ids_[index]; }
+
+  inline void SetDirectoryPageId(uint32_t index, page_id_t page_id) { directory_page_ids_[index] = page_id; }
+
+  /** Slots are numbered within the page, from 0 to SLOTS_PER_PAGE. */
+  inline page_id_t GetBucketPageId(uint32_t slot) const { return bucket_page_ids_[slot]; }
+
+  inline void SetBucketPageId(uint32_t slot, page_id_t bucket_page_id) { bucket_page_ids_[slot] = bucket_page_id; }
+
+  inline uint32_t GetLocalDepth(uint32_t slot) const { return local_depths_[slot]; }
+
+  inline void SetLocalDepth(uint32_t slot, uint32_t local_depth) {
+    local_depths_[slot] = static_cast<uint8_t>(local_depth);
+  }
+
+  /** Copy `count` slots of `from`, starting at `from_slot`, to the slots of this page starting at `to_slot`. */
+  void CopySlots(uint32_t to_slot, const ExtendibleHashDirectoryPage *from, uint32_t from_slot, uint32_t count);
+
+ private:
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[SLOTS_PER_PAGE];
+  page_id_t bucket_page_ids_[SLOTS_PER_PAGE];
+  page_id_t directory_page_ids_[MAX_PAGES];
+};
+
+static_assert(sizeof(ExtendibleHashDirectoryPage) <= PAGE_SIZE, "Hash directory page does not fit in a page.");
+
+using HashDirectoryPage = ExtendibleHashDirectoryPage;
+#endif  // MINISQL_EXTENDIBLE_HASH_DIRECTORY_PAGE_H
@@ -76,6 +76,23 @@ class Page {
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** True if the page was loaded by read-ahead and nobody has fetched it since. */
+  bool prefetched_ = false;
+  /**
+   * Pins of pin_count_ held by the buffer pool's own background threads, they are released without any caller.
+   * Only read and written with the latch of the buffer pool instance held.
+   */
+  int background_pins_ = 0;
+  /**
+   * Bumped whenever the page is unpinned dirty, tells the page cleaner whether its write back is still current.
+   * Only read and written with the latch of the buffer pool instance held.
+   */
+  uint32_t dirty_version_ = 0;
+  /**
+   * True while the page cleaner writes a copy of the page without holding the latch of its instance. Set with the
+   * instance latch held and cleared with the instance's background latch held; FlushFrame holds both to wait on it.
+   */
+  bool writing_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
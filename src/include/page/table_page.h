@@ -47,6 +47,13 @@ class TablePage : public Page {
 
   bool InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Insert a row of `serialized_size` bytes into a new slot after the last one, without looking for an empty slot to
+   * reuse. For bulk loads, which size every row once and fill pages front to back.
+   * @return false if the page has no room for the row and its slot
+   */
+  bool AppendTuple(Row &row, uint32_t serialized_size, Schema *schema);
+
   bool MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
   bool UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Transaction *txn, LockManager *lock_manager,
@@ -62,6 +69,11 @@ class TablePage : public Page {
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /** @return bytes left between the slot array and the tuples, a new tuple needs its size plus SIZE_TUPLE */
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
  private:
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
@@ -73,10 +85,6 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
   }
@@ -103,7 +111,6 @@ class TablePage : public Page {
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
-  static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
@@ -112,6 +119,7 @@ class TablePage : public Page {
   static constexpr size_t OFFSET_TUPLE_SIZE = 28;
 
  public:
+  static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
 };
 
@@ -1,5 +1,6 @@
 %{
   #include <stdio.h>
+  #include <strings.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -22,11 +23,11 @@
 %type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
 %type <syntax_node> sql_show_tables sql_create_table sql_drop_table
 %type <syntax_node> column_definition_list column_definition column_type column_list
-%type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
+%type <syntax_node> sql_create_index index_include sql_drop_index sql_show_indexes
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
-%type <syntax_node> sql_insert sql_delete sql_update update_values update_value
+%type <syntax_node> sql_insert insert_rows insert_row sql_delete sql_update update_values update_value
 %type <syntax_node> sql_quit sql_exec_file
 
 %%
@@ -180,6 +181,39 @@ sql_create_index:
       SyntaxNodeAddChildren(index_type_node, $10);
       SyntaxNodeAddChildren($$, index_type_node);
   }
+  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_include {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
+      SyntaxNodeAddChildren($$, $3);
+      SyntaxNodeAddChildren($$, $5);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $7);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      SyntaxNodeAddChildren($$, $9);
+  }
+  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_include USING IDENTIFIER {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
+      SyntaxNodeAddChildren($$, $3);
+      SyntaxNodeAddChildren($$, $5);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $7);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      SyntaxNodeAddChildren($$, $9);
+      pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
+      SyntaxNodeAddChildren(index_type_node, $11);
+      SyntaxNodeAddChildren($$, index_type_node);
+  }
+  ;
+
+/* INCLUDE is not a keyword, so that columns may still be named include */
+index_include:
+  IDENTIFIER '(' column_list ')' {
+    if (strcasecmp($1->val_, "include") != 0) {
+      yyerror("syntax error");
+      YYABORT;
+    }
+    $$ = CreateSyntaxNode(kNodeIndexInclude, "index include");
+    SyntaxNodeAddChildren($$, $3);
+  }
   ;
 
 sql_drop_index:
@@ -289,12 +323,27 @@ operator:
   ;
 
 sql_insert:
-  INSERT INTO IDENTIFIER VALUES '(' column_values ')' {
+  INSERT INTO IDENTIFIER VALUES insert_rows {
     $$ = CreateSyntaxNode(kNodeInsert, NULL);
     SyntaxNodeAddChildren($$, $3);
-    pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, $6);
-    SyntaxNodeAddChildren($$, col_val_node);
+    SyntaxNodeAddChildren($$, $5);
+  }
+  ;
+
+insert_rows:
+  insert_row ',' insert_rows {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | insert_row {
+    $$ = $1;
+  }
+  ;
+
+insert_row:
+  '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $2);
   }
   ;
 
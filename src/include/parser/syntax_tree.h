@@ -41,6 +41,7 @@ typedef enum {
   kNodeCreateIndex,          /** create index command */
   kNodeDropIndex,            /** drop index command */
   kNodeIndexType,            /** type of index */
+  kNodeIndexInclude,         /** columns stored in an index besides its key, contains several columns */
   kNodeTrxBegin,             /** begin transaction command */
   kNodeTrxCommit,            /** commit transaction command */
   kNodeTrxRollback           /** rollback transaction command */
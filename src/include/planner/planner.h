@@ -7,6 +7,7 @@
 
 #include "common/instance.h"
 #include "executor/plans/abstract_plan.h"
+#include "executor/plans/bitmap_heap_scan_plan.h"
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
@@ -43,8 +44,44 @@ class Planner {
   /** the root plan node of the plan tree */
   AbstractPlanNodeRef plan_;
 
+  /**
+   * Pick the access path for the rows of `table_name` matching `where`: a sequential scan, an index scan, or a bitmap
+   * heap scan over one or more indexes. A scan whose rows an UPDATE or DELETE will change (`modifies`) collects all of
+   * its row ids before returning the first row, so the statement never meets a row it changed again.
+   */
+  AbstractPlanNodeRef PlanScan(const std::string &table_name, const Schema *out_schema,
+                               const AbstractExpressionRef &where, bool modifies);
+
+  /** PlanScan over the given `indexes` of the table rather than those the catalog has for it. */
+  static AbstractPlanNodeRef PlanScan(const std::string &table_name, const std::vector<IndexInfo *> &indexes,
+                                      const Schema *out_schema, const AbstractExpressionRef &where, bool modifies);
+
   Schema *MakeOutputSchema(const std::vector<std::pair<std::string, AbstractExpressionRef>> &exprs);
 
+  /** Split a predicate into the terms of its top-level ANDs, or ORs. */
+  static void SplitLogic(const AbstractExpressionRef &predicate, LogicType logic_type,
+                         std::vector<AbstractExpressionRef> &terms);
+
+  /**
+   * Match conjuncts against the key of `index`: equalities on the first key columns, then a range on the key column
+   * after them, or for a hash index equalities on all key columns. The conjuncts the key range answers are marked in
+   * `used`.
+   */
+  static IndexKeyRange MatchIndex(IndexInfo *index, const std::vector<AbstractExpressionRef> &conjuncts,
+                                  std::vector<bool> &used);
+
+  /**
+   * Match conjuncts against all `indexes` for a bitmap heap scan: the best key range is ANDed with indexes whose whole
+   * key the conjuncts give, and an OR conjunct whose terms all match some index becomes the union of their row ids.
+   * The conjuncts the row ids answer exactly are marked in `used`. @return nullptr if no index helps
+   */
+  static BitmapIndexConditionRef MatchBitmap(const std::vector<IndexInfo *> &indexes,
+                                             const std::vector<AbstractExpressionRef> &conjuncts,
+                                             std::vector<bool> &used);
+
+  /** @return whether the key schema of `index` has every column of `out_schema` and of `predicate` */
+  static bool Covers(IndexInfo *index, const Schema *out_schema, const AbstractExpressionRef &predicate);
+
   /** Catalog will be used during the planning process. SHOULD ONLY BE USED IN
    * CODE PATH OF `PlanQuery`.
    */
@@ -97,6 +97,14 @@ class Field {
 
   inline uint32_t GetSerializedSize() const { return Type::GetInstance(type_id_)->GetSerializedSize(*this, is_null_); }
 
+  inline uint32_t SerializeToKey(char *buf) const { return Type::GetInstance(type_id_)->SerializeToKey(*this, buf); }
+
+  inline static uint32_t DeserializeFromKey(char *buf, const TypeId type_id, Field **field) {
+    return Type::GetInstance(type_id)->DeserializeFromKey(buf, field);
+  }
+
+  inline uint32_t GetKeySerializedSize() const { return Type::GetInstance(type_id_)->GetKeySerializedSize(*this); }
+
   inline bool CheckComparable(const Field &o) const { return type_id_ == o.type_id_; }
 
   inline CmpBool CompareEquals(const Field &o) const { return Type::GetInstance(type_id_)->CompareEquals(*this, o); }
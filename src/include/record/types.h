@@ -49,6 +49,15 @@ class Type {
   // Get serialize size of a field
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const;
 
+  // Serialize a non-null field into an index key, so that memcmp on the bytes orders fields like CompareLessThan.
+  virtual uint32_t SerializeToKey(const Field &field, char *buf) const;
+
+  // Deserialize a non-null field written by SerializeToKey.
+  virtual uint32_t DeserializeFromKey(char *storage, Field **field) const;
+
+  // Get the size SerializeToKey writes for a non-null field
+  virtual uint32_t GetKeySerializedSize(const Field &field) const;
+
   // Access the raw variable length data
   virtual const char *GetData(const Field &val) const;
 
@@ -82,6 +91,12 @@ class TypeInt : public Type {
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
+  virtual uint32_t SerializeToKey(const Field &field, char *buf) const override;
+
+  virtual uint32_t DeserializeFromKey(char *storage, Field **field) const override;
+
+  virtual uint32_t GetKeySerializedSize(const Field &field) const override;
+
   virtual CmpBool CompareEquals(const Field &left, const Field &right) const override;
 
   virtual CmpBool CompareNotEquals(const Field &left, const Field &right) const override;
@@ -105,6 +120,12 @@ class TypeChar : public Type {
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
+  virtual uint32_t SerializeToKey(const Field &field, char *buf) const override;
+
+  virtual uint32_t DeserializeFromKey(char *storage, Field **field) const override;
+
+  virtual uint32_t GetKeySerializedSize(const Field &field) const override;
+
   virtual const char *GetData(const Field &val) const override;
 
   virtual uint32_t GetLength(const Field &val) const override;
@@ -132,6 +153,12 @@ class TypeFloat : public Type {
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
+  virtual uint32_t SerializeToKey(const Field &field, char *buf) const override;
+
+  virtual uint32_t DeserializeFromKey(char *storage, Field **field) const override;
+
+  virtual uint32_t GetKeySerializedSize(const Field &field) const override;
+
   virtual CmpBool CompareEquals(const Field &left, const Field &right) const override;
 
   virtual CmpBool CompareNotEquals(const Field &left, const Field &right) const override;
@@ -2,15 +2,30 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/io_uring.h"
+
+/**
+ * One page read or write of a DiskManager::ExecuteBatch.
+ */
+struct PageIORequest {
+  page_id_t logical_page_id_;
+  char *data_;  // destination of a read, source of a write
+  bool is_write_;
+  std::function<void()> callback_;  // called once the request completed, may be empty
+};
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -19,10 +34,21 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * One meta page records the usage of EXTENTS_PER_META extents. Past them the file continues with the next group, laid
+ * out the same way and starting with its own meta page:
+ * | Meta Page 0 | extents 0 .. E-1 | Meta Page 1 | extents E .. 2E-1 | ...
+ * Group 0 is exactly the layout of a file with a single meta page, so such files are read as they are. The meta page
+ * of group g sits at a fixed position, so the meta pages form an implicit chain that needs no pointers. Which extents
+ * still have room is kept in memory (free_extents_), so allocating does not scan the meta pages.
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param io_queue_depth number of page I/Os ExecuteBatch keeps in flight through io_uring (DEFAULT_IO_QUEUE_DEPTH is
+   * a good start), 0 or a kernel without io_uring selects the synchronous pread/pwrite path
+   */
+  explicit DiskManager(const std::string &db_file, uint32_t io_queue_depth = 0);
 
   ~DiskManager() {
     if (!closed) {
@@ -42,12 +68,31 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Perform a batch of page reads and writes, keeping up to io_queue_depth of them in flight at once. Returns after
+   * every request completed; callbacks run on the calling thread in completion order. Requests of one batch must not
+   * touch the same page.
+   */
+  void ExecuteBatch(std::vector<PageIORequest> &requests);
+
+  /** @return whether ExecuteBatch goes through io_uring */
+  inline bool IsUsingIOUring() const { return io_uring_ != nullptr; }
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
    */
   page_id_t AllocatePage();
 
+  /**
+   * Get a free page physically next to `near_page_id`, the page a table heap or index grew from last. The first page
+   * allocated behind a page starts a run: up to EXTENT_RUN_SIZE - 1 further pages after it are reserved for the same
+   * chain and skipped by every other allocation, and the file is grown over the whole run with fallocate. Reservations
+   * only live in memory and are dropped when nothing else is free.
+   * @return logical page id of allocated page, falls back to AllocatePage() for INVALID_PAGE_ID
+   */
+  page_id_t AllocatePage(page_id_t near_page_id);
+
   /**
    * Free this page and reset bit map
    */
@@ -58,48 +103,120 @@ class DiskManager {
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write the cached meta page and extent bitmaps back if they changed. Allocation state lives in memory between
+   * calls, Close and the buffer pool's page cleaner call this.
+   */
+  void FlushMetaData();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
   void Close();
 
   /**
-   * Get Meta Page
+   * Get the meta page of the first group
    * Note: Used only for debug
    */
-  char *GetMetaData() { return meta_data_; }
+  char *GetMetaData() { return reinterpret_cast<char *>(GetMetaPage(0)); }
 
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+  static constexpr uint32_t EXTENTS_PER_META = (PAGE_SIZE - sizeof(DiskFileMetaPage)) / sizeof(uint32_t);
+  static constexpr uint32_t MAX_EXTENTS = MAX_VALID_PAGE_ID / BITMAP_SIZE;
+  static constexpr uint32_t NUM_META_GROUPS = (MAX_EXTENTS + EXTENTS_PER_META - 1) / EXTENTS_PER_META;
 
  private:
   /**
    * Helper function to get disk file size
    */
-  int GetFileSize(const std::string &file_name);
+  int64_t GetFileSize(const std::string &file_name);
 
   /**
-   * Read physical page from disk
+   * Read physical page from disk. Uses pread, so concurrent reads need no latch.
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  void ReadPhysicalPage(uint64_t physical_page_id, char *page_data);
 
   /**
-   * Write data to physical page in disk
+   * Write data to physical page in disk. Uses pwrite and extends the tracked file size.
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  void WritePhysicalPage(uint64_t physical_page_id, const char *page_data);
 
   /**
-   * Map logical page id to physical page id
+   * @return the cached bitmap of an extent, read from disk on first use. Caller must hold db_io_latch_.
    */
-  page_id_t MapPageId(page_id_t logical_page_id);
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /** @return the cached meta page of a group, read from disk on first use. Caller must hold db_io_latch_. */
+  DiskFileMetaPage *GetMetaPage(uint32_t group_id);
+
+  /** Read the meta pages present in the file and build the directory of extents with room. */
+  void LoadSpaceMap();
+
+  /** @return number of pages in use in an extent, according to its group's meta page */
+  uint32_t GetExtentUsedPages(uint32_t extent_id);
+
+  /** Account for a page just set in its bitmap in the meta page. Caller must hold db_io_latch_. */
+  void MarkAllocated(page_id_t logical_page_id);
+
+  /** Add delta to the used page count of an extent and update the directory. Caller must hold db_io_latch_. */
+  void UpdateExtentUsage(uint32_t extent_id, int32_t delta);
+
+  /** @return whether a page lies in a run reserved by AllocatePage(near_page_id) */
+  bool IsPageReserved(page_id_t logical_page_id);
+
+  /** @return number of consecutive free, unreserved pages from a free, unreserved page on, at most max_length */
+  uint32_t FreeRunLength(page_id_t logical_page_id, uint32_t max_length);
+
+  /** @return the first page starting run_size consecutive free, unreserved pages of one extent, or INVALID_PAGE_ID */
+  page_id_t FindFreeRun(uint32_t run_size);
+
+  /** Grow the file over the pages [first_page_id, end_page_id) of one extent if they lie past its end. */
+  void Preallocate(page_id_t first_page_id, page_id_t end_page_id);
+
+  /**
+   * Pop every available completion of the ring, finish its request and mark it in `done`.
+   * Caller must hold io_uring_latch_.
+   * @return number of requests completed
+   */
+  size_t ReapCompletions(std::vector<PageIORequest> &requests, std::vector<bool> &done);
+
+  /**
+   * Account for a completed physical write, growing the tracked file size.
+   */
+  void ExtendFileSize(size_t end);
+
+  /**
+   * Map logical page id to physical page id. Physical ids of large files do not fit a page_id_t.
+   */
+  uint64_t MapPageId(page_id_t logical_page_id);
+
+  uint64_t GetMetaPhysicalId(uint32_t group_id);
+
+  uint64_t GetBitmapPhysicalId(uint32_t extent_id);
 
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, every access is positional (pread/pwrite) so there is no shared cursor
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // file length in bytes, tracked in memory instead of stat() on every read
+  std::atomic<size_t> file_size_{0};
+  // protects the meta page and the bitmap pages, page reads and writes run without it
   std::recursive_mutex db_io_latch_;
+  // asynchronous backend of ExecuteBatch, null when running synchronously
+  std::unique_ptr<IOUring> io_uring_;
+  std::mutex io_uring_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];
+  // in-memory copies of the meta pages, indexed by group id, loaded lazily and written back by FlushMetaData
+  std::vector<std::unique_ptr<char[]>> meta_pages_;
+  std::vector<bool> meta_dirty_;
+  // extents below next_extent_ that have free pages, every extent from next_extent_ on has never been used
+  std::set<uint32_t> free_extents_;
+  uint32_t next_extent_{0};
+  // in-memory copies of the extent bitmaps, indexed by extent id, loaded lazily and written back by FlushMetaData
+  std::vector<std::unique_ptr<BitmapPage<PAGE_SIZE>>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  // runs reserved for growing chains, first page still free -> end of the run (exclusive), see AllocatePage(near)
+  std::map<page_id_t, page_id_t> reserved_runs_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * FreeSpaceMap remembers roughly how much room every page of a table heap has left, so that an insert can go straight
+ * to a page it fits in instead of trying the pages of the chain one after another.
+ *
+ * Free space is recorded in buckets of BUCKET_SIZE bytes, a page in bucket b has at least b * BUCKET_SIZE free bytes.
+ * The map lives in memory only, a table heap rebuilds it from its pages after being opened.
+ */
+class FreeSpaceMap {
+ public:
+  FreeSpaceMap() : buckets_(NUM_BUCKETS) {}
+
+  /**
+   * Record the free space of a page, replacing whatever was recorded for it before.
+   */
+  void Update(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Forget a page, e.g. one that no longer belongs to the table.
+   */
+  void Remove(page_id_t page_id);
+
+  /**
+   * @return a page with at least `size` free bytes, preferring the fullest bucket that fits and within it the lowest
+   * page id, or INVALID_PAGE_ID if no page is known to have that much room
+   */
+  page_id_t FindPage(uint32_t size) const;
+
+  void Clear();
+
+ private:
+  static constexpr uint32_t BUCKET_SIZE = 64;
+  static constexpr uint32_t NUM_BUCKETS = 64;
+  static_assert(NUM_BUCKETS <= 64, "Non-empty buckets are tracked in one 64-bit word.");
+
+  std::vector<std::set<page_id_t>> buckets_;
+  std::unordered_map<page_id_t, uint32_t> page_bucket_;
+  uint64_t non_empty_buckets_{0};  // bit b is set iff buckets_[b] is not empty
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
@@ -0,0 +1,95 @@
+#ifndef MINISQL_IO_URING_H
+#define MINISQL_IO_URING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * IOUring is a minimal wrapper around one Linux io_uring instance (submission and completion queue) used by
+ * DiskManager to keep many page reads and writes in flight with a single syscall per batch.
+ *
+ * The ring talks to the kernel through the raw syscalls, so no liburing is needed. When the build does not define
+ * ENABLE_IO_URING, or the kernel refuses to set up the ring, IsValid() returns false and the caller is expected to use
+ * the synchronous path instead.
+ *
+ * An IOUring is not thread safe, the owner serializes access.
+ */
+class IOUring {
+ public:
+  /**
+   * Set up a ring.
+   * @param entries submission queue size, the kernel rounds it up to a power of two
+   */
+  explicit IOUring(uint32_t entries);
+
+  ~IOUring();
+
+  IOUring(const IOUring &) = delete;
+  IOUring &operator=(const IOUring &) = delete;
+
+  /** @return whether the ring was set up and can be used */
+  inline bool IsValid() const { return ring_fd_ >= 0; }
+
+  /** @return number of entries of the submission queue */
+  inline uint32_t GetNumEntries() const { return sq_entries_; }
+
+  /**
+   * Queue a read of `len` bytes at `offset` of `fd` into `buf`. Nothing is sent to the kernel before Submit.
+   * @return false if the submission queue is full
+   */
+  bool PrepareRead(int fd, char *buf, uint32_t len, uint64_t offset, uint64_t user_data);
+
+  /**
+   * Queue a write of `len` bytes from `buf` at `offset` of `fd`. Nothing is sent to the kernel before Submit.
+   * @return false if the submission queue is full
+   */
+  bool PrepareWrite(int fd, const char *buf, uint32_t len, uint64_t offset, uint64_t user_data);
+
+  /**
+   * Hand every queued request to the kernel and wait until at least `wait_nr` completions are available.
+   * @return false on error
+   */
+  bool Submit(uint32_t wait_nr);
+
+  /**
+   * Wait until at least `wait_nr` completions are available, without handing queued requests to the kernel.
+   * @return false on error
+   */
+  bool Wait(uint32_t wait_nr);
+
+  /** @return number of prepared entries not yet taken by the kernel */
+  inline uint32_t GetNumUnsubmitted() const { return to_submit_; }
+
+  /**
+   * Pop one completion without blocking.
+   * @param[out] user_data the value given when the request was prepared
+   * @param[out] res bytes transferred, or a negative errno
+   * @return false if no completion is available
+   */
+  bool PopCompletion(uint64_t *user_data, int32_t *res);
+
+ private:
+  bool Prepare(uint8_t opcode, int fd, uint64_t addr, uint32_t len, uint64_t offset, uint64_t user_data);
+
+  int ring_fd_{-1};
+  uint32_t sq_entries_{0};
+  uint32_t to_submit_{0};  // prepared but not yet submitted entries
+  // shared ring memory
+  void *sq_ring_{nullptr};
+  void *cq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // pointers into the shared memory
+  uint32_t *sq_head_{nullptr};
+  uint32_t *sq_tail_{nullptr};
+  uint32_t *sq_mask_{nullptr};
+  uint32_t *sq_array_{nullptr};
+  uint32_t *cq_head_{nullptr};
+  uint32_t *cq_tail_{nullptr};
+  uint32_t *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+};
+
+#endif  // MINISQL_IO_URING_H
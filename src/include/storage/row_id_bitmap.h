@@ -0,0 +1,59 @@
+#ifndef MINISQL_ROW_ID_BITMAP_H
+#define MINISQL_ROW_ID_BITMAP_H
+
+#include <map>
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * RowIdBitmap is a set of row ids grouped by heap page: one bit per slot, one word vector per page, pages in id order.
+ *
+ * An index returns row ids in key order, which visits the heap pages in random order and the same page many times.
+ * Collecting them here first lets a scan visit every page once, in the order the table heap allocated them, and read
+ * all the slots it wants from a page while it is pinned. Adding a row id twice keeps it once.
+ *
+ * Bitmaps of several index conditions are combined page by page, a word at a time, so AND and OR of large row id sets
+ * cost a few instructions per 64 slots and never compare row ids one by one.
+ */
+class RowIdBitmap {
+ public:
+  /** Slot bits of one page, bit i of word w is slot w * 64 + i */
+  using SlotWords = std::vector<uint64_t>;
+  using PageMap = std::map<page_id_t, SlotWords>;
+
+  /** @return false if `rid` was already there */
+  bool Add(const RowId &rid);
+
+  bool Contains(const RowId &rid) const;
+
+  /** @return number of row ids */
+  inline size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+
+  /** @return number of pages holding at least one row id */
+  inline size_t GetPageCount() const { return pages_.size(); }
+
+  /** @return the slot bits of every page, in page id order */
+  inline const PageMap &GetPages() const { return pages_; }
+
+  /** Keep only the row ids that are also in `other` (AND). */
+  void IntersectWith(const RowIdBitmap &other);
+
+  /** Add every row id of `other` (OR). */
+  void UnionWith(const RowIdBitmap &other);
+
+  /** Append the slots set in `words` to `slots`, in order. */
+  static void CollectSlots(const SlotWords &words, std::vector<uint32_t> &slots);
+
+  void Clear();
+
+ private:
+  static size_t CountSlots(const SlotWords &words);
+
+  PageMap pages_;
+  size_t size_{0};
+};
+
+#endif  // MINISQL_ROW_ID_BITMAP_H
@@ -4,6 +4,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
+#include "storage/free_space_map.h"
 #include "storage/table_iterator.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
@@ -26,12 +27,22 @@ class TableHeap {
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * The target page is picked through the free space map, so space freed by deletes anywhere in the table is reused.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Insert many tuples at once. A page is pinned once and filled until the next row does not fit, instead of being
+   * fetched and unpinned for every row.
+   * @param[in/out] rows Rows to insert, the rid of every inserted tuple is wrapped in its row
+   * @param[in] txn The transaction performing the insert
+   * @return true iff every row was inserted, on failure the rows already inserted are deleted again
+   */
+  bool BulkInsert(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -71,6 +82,18 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Read several tuples of one page, pinning the page once for all of them.
+   * @param[in] page_id The page to read
+   * @param[in] slots Slots of the tuples, in order
+   * @param[out] rows The tuples that exist are appended, in the order of `slots`, deleted slots are skipped
+   * @param[in] txn transaction performing the read
+   * @param[in] ring optional bulk-read strategy, for a sweep over many pages
+   * @return false if the page could not be fetched
+   */
+  bool GetTuples(page_id_t page_id, const std::vector<uint32_t> &slots, std::vector<Row> &rows, Transaction *txn,
+                 BufferRing *ring = nullptr);
+
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
@@ -89,9 +112,10 @@ class TableHeap {
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
   /**
+   * @param ring optional bulk-read strategy, a full scan should pass one so it does not flush the buffer pool
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, BufferRing *ring = nullptr);
 
   /**
    * @return the end iterator of this table
@@ -106,6 +130,17 @@ class TableHeap {
   inline page_id_t GetCurrentPageId() const { return current_page_id_; }
 
 private:
+  /**
+   * Record the free space of every page of the chain, done once before the first insert into an opened table.
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Link a new page, allocated next to the last one, to the end of the chain.
+   * @return the new page, pinned, or nullptr if the buffer pool is out of frames
+   */
+  TablePage *AppendPage(Transaction *txn);
+
   /**
    * create table heap and initialize first page
    */
@@ -118,8 +153,11 @@ private:
     //ASSERT(false, "Not implemented yet.");
     TablePage* first_page = reinterpret_cast<TablePage*>(buffer_pool_manager_->NewPage(first_page_id_));
     first_page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, txn);
+    free_space_map_.Update(first_page_id_, first_page->GetFreeSpaceRemaining());
     buffer_pool_manager_->UnpinPage(first_page_id_, true);
     current_page_id_ = first_page_id_;
+    last_page_id_ = first_page_id_;
+    free_space_map_loaded_ = true;
   };
 
   /**
@@ -138,6 +176,9 @@ private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
   page_id_t current_page_id_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  FreeSpaceMap free_space_map_;
+  bool free_space_map_loaded_{false};  // false until LoadFreeSpaceMap walked the pages of an opened table
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
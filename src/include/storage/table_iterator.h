@@ -1,6 +1,7 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include "buffer/buffer_ring.h"
 #include "common/rowid.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
@@ -10,15 +11,16 @@ class TableHeap;
 class TableIterator {
 public:
   // you may define your own constructor based on your member variables
-  explicit TableIterator(TableHeap *table_heap, RowId rid);
+  // pages are fetched through `ring` when it is not null, see BufferRing
+  explicit TableIterator(TableHeap *table_heap, RowId rid, BufferRing *ring = nullptr);
 
   TableIterator(const TableIterator &other);
 
   virtual ~TableIterator();
 
-  inline bool operator==(const TableIterator &itr) const;
+  bool operator==(const TableIterator &itr) const;
 
-  inline bool operator!=(const TableIterator &itr) const;
+  bool operator!=(const TableIterator &itr) const;
 
   const Row &operator*();
 
@@ -34,6 +36,7 @@ private:
   // add your own private member variables here
   TableHeap *table_heap_;
   Row *row_;
+  BufferRing *ring_;
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
@@ -1,5 +1,6 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
 #include <string>
 
 #include "glog/logging.h"
@@ -12,17 +13,28 @@
  * BPlusTree::BPlusTree函数中，如果传入的leaf_max_size和internal_max_size是默认值0，即UNDEFINED_SIZE，那么需要自己根据keysize进行计算
  */
 BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
-                     int leaf_max_size, int internal_max_size)
+                     int leaf_max_size, int internal_max_size, bool unique, uint32_t key_column_count)
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {
+      internal_max_size_(internal_max_size),
+      value_size_(unique ? sizeof(RowId) : INDEX_INLINE_POSTING_SIZE * sizeof(RowId)),
+      key_column_count_(unique ? key_column_count : 0) {
 	
+	if (leaf_max_size_ == UNDEFINED_SIZE) {
+		leaf_max_size_ = LeafPageMaxSize(processor_.GetKeySize(), value_size_);
+	}
+	if (internal_max_size_ == UNDEFINED_SIZE) {
+		internal_max_size_ = InternalPageMaxSize(processor_.GetKeySize());
+	}
 	root_page_id_ = INVALID_PAGE_ID;
-	IndexRootsPage *root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
+	Page *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+	IndexRootsPage *root_page = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
 	page_id_t root_page_id;
+	header_page->RLatch();
 	bool flag = root_page->GetRootId(index_id, &root_page_id);
+	header_page->RUnlatch();
 	buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
 	if (flag == true) {
 		root_page_id_ = root_page_id;
@@ -44,21 +56,24 @@ bool BPlusTree::IsEmpty() const {
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key, one for a unique tree
  * This method is used for point query
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
-	bool flag = false;
-	Page *p = FindLeafPage(key);
-	RowId value;
+	std::vector<Page *> path;
+	bool root_locked = false;
+	Page *p = FindLeafPage(key, LatchMode::kRead, path, root_locked);
+	if (p == nullptr) {
+		return false;
+	}
 	LeafPage *node = reinterpret_cast<LeafPage *>(p->GetData());
-	flag = node->Lookup(key, value, processor_);
-	if (flag) {
-		result.push_back(value);
+	int index = node->KeyIndex(key, processor_);
+	bool flag = index < node->GetSize() && processor_.CompareKeys(key, node->KeyAt(index)) == 0;
+	if (flag) { // 持有叶子的读锁，posting page 不会被改
+		PostingPage::CollectRowIds(node->ValuesAt(index), value_size_ / sizeof(RowId), buffer_pool_manager_, result);
 	}
-	buffer_pool_manager_->UnpinPage(p->GetPageId(), false);
-
+	ReleaseLatches(path, root_locked, false, false);
 	return flag;
 }
 
@@ -69,16 +84,36 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Tran
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert entry
  * , otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true. Deal in ::InsertIntoLeaf.
+ * @return: if user try to insert a duplicate key into a unique tree, or a
+ * duplicate pair into a non-unique tree, return false, otherwise return true.
+ * Deal in ::InsertIntoLeaf.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction) {
-	if (IsEmpty()) {
+	std::vector<Page *> path;
+	bool root_locked = false;
+	// 乐观：读锁下降到叶子，叶子不会分裂就直接插入
+	Page *leaf_page = FindLeafPage(key, LatchMode::kOptimistic, path, root_locked);
+	if (leaf_page != nullptr) {
+		LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+		int index = leaf_node->KeyIndex(key, processor_);
+		bool exists = index < leaf_node->GetSize() && processor_.CompareKeys(key, leaf_node->KeyAt(index)) == 0;
+		if (exists || leaf_node->GetSize() < leaf_node->GetMaxSize()) { // 已有的 key 只加 RowId，叶子不会分裂
+			bool inserted = InsertIntoLeaf(leaf_page, key, value, transaction);
+			ReleaseLatches(path, root_locked, true, inserted);
+			return inserted;
+		}
+		ReleaseLatches(path, root_locked, true, false);
+	}
+	// 悲观：写锁下降，只保留可能分裂的那段路径
+	leaf_page = FindLeafPage(key, LatchMode::kInsert, path, root_locked);
+	if (leaf_page == nullptr) { // 持有 root_latch_，空树可以直接建
 		StartNewTree(key, value);
+		ReleaseLatches(path, root_locked, true, true);
 		return true;
-	} else {
-		return InsertIntoLeaf(key, value, transaction);
 	}
+	bool inserted = InsertIntoLeaf(leaf_page, key, value, transaction);
+	ReleaseLatches(path, root_locked, true, inserted);
+	return inserted;
 }
 /*
  * Insert constant key & value pair into an empty tree
@@ -96,7 +131,7 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
 	UpdateRootPageId(1);
 	LeafPage *leaf_node = reinterpret_cast<LeafPage *>(root_page->GetData());
 	int key_size = processor_.GetKeySize();
-	leaf_node->Init(root_page_id_, INVALID_PAGE_ID, key_size, leaf_max_size_); // where to init key_size?
+	leaf_node->Init(root_page_id_, INVALID_PAGE_ID, key_size, leaf_max_size_, value_size_); // where to init key_size?
 	leaf_node->Insert(key, value, processor_);
 	buffer_pool_manager_->UnpinPage(root_page->GetPageId(), true);
 }
@@ -106,28 +141,38 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immediately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * A non-unique tree adds the value to the row ids of an existing key.
+ * @return: if user try to insert a duplicate key into a unique tree, or a
+ * duplicate pair into a non-unique tree, return false, otherwise return true.
  */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction) {
+bool BPlusTree::InsertIntoLeaf(Page *page, GenericKey *key, const RowId &value, Transaction *transaction) {
 	bool flag = false;
 
-	Page *page = FindLeafPage(key);
 	LeafPage *node = reinterpret_cast<LeafPage *>(page->GetData());
+	int index = node->KeyIndex(key, processor_);
+	if (index < node->GetSize() && processor_.CompareKeys(key, node->KeyAt(index)) == 0) {
+		return !IsUnique() && PostingInsert(node, index, value);
+	}
+	// 同 key 列的 key 都在这个叶子里，最多一个，紧挨着插入位置
+	if (key_column_count_ > 0 && ((index < node->GetSize() && IsDuplicate(key, node->KeyAt(index))) ||
+	                              (index > 0 && IsDuplicate(key, node->KeyAt(index - 1))))) {
+		return false;
+	}
 	int old_size = node->GetSize();
 	int new_size = node->Insert(key, value, processor_);
 
 	if (old_size == new_size) { // duplicate
-		buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
 		flag = false;
 	} else if (node->GetMaxSize() < new_size) { // overflow
 		LeafPage *new_node = Split(node, transaction);
-		InsertIntoParent(node, new_node->KeyAt(0), new_node, transaction);
-		buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+		GenericKey *separator = processor_.InitKey();
+		memcpy(separator, new_node->KeyAt(0), processor_.GetKeySize());
+		ToSeparator(separator);
+		InsertIntoParent(node, separator, new_node, transaction);
+		free(separator);
 		buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
 		flag = true;
 	} else { // normal
-		buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 		flag = true;
 	}
 
@@ -143,7 +188,7 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
  */
 BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transaction) {
 	page_id_t new_page_id = INVALID_PAGE_ID;
-	Page* new_page = buffer_pool_manager_->NewPage(new_page_id);
+	Page* new_page = buffer_pool_manager_->NewPage(new_page_id, node->GetPageId());
 	if (new_page == nullptr) {
 		throw std::runtime_error("out of memory");
 	}
@@ -157,13 +202,13 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transac
 
 BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
 	page_id_t new_page_id = INVALID_PAGE_ID;
-	Page* new_page = buffer_pool_manager_->NewPage(new_page_id);
+	Page* new_page = buffer_pool_manager_->NewPage(new_page_id, node->GetPageId());
 	if (new_page == nullptr) {
 		throw std::runtime_error("out of memory");
 	}
 	LeafPage *new_node = reinterpret_cast<LeafPage *>(new_page->GetData());
 	new_node->SetPageType(IndexPageType::LEAF_PAGE);
-	new_node->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
+	new_node->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_, value_size_);
 	node->MoveHalfTo(new_node);
 	// update 链表
 	new_node->SetNextPageId(node->GetNextPageId());
@@ -215,6 +260,172 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
 	return;
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree bottom-up from sorted entries.
+ * Every level is planned up front: the leaves from the number of entries, each
+ * internal level from the number of pages below it, until a level has a single
+ * page, the root. While the leaves are filled, one page per level is kept
+ * pinned; a page that got its planned number of entries is appended to the
+ * page being filled one level up, which is started on demand.
+ */
+bool BPlusTree::BulkLoad(KeySorter &sorter, double fill_factor, [[maybe_unused]] Transaction *transaction) {
+	root_latch_.WLock();
+	ASSERT(IsEmpty(), "Bulk load into a non-empty tree.");
+	// 非唯一索引一个 key 只占一个叶子 entry，按不同 key 的个数规划
+	size_t count = IsUnique() ? sorter.GetCount() : sorter.CountKeys();
+	if (count == 0) {
+		root_latch_.WUnlock();
+		return true;
+	}
+	// internal pages split when they reach max size, so they hold one entry less at rest
+	std::vector<BulkLoadLevel> levels;
+	levels.push_back(PlanLevel(count, leaf_max_size_, leaf_max_size_ / 2, fill_factor));
+	while (levels.back().nodes_ > 1) {
+		levels.push_back(PlanLevel(levels.back().nodes_, internal_max_size_ - 1, internal_max_size_ / 2, fill_factor));
+	}
+
+	bool ok = true;
+	GenericKey *key = nullptr;
+	GenericKey *last_key = processor_.InitKey();
+	RowId value;
+	std::vector<RowId> rids; // last_key 的 RowId
+	size_t loaded = 0;
+	while (sorter.Next(key, value)) {
+		if (!rids.empty() && (IsUnique() ? IsDuplicate(key, last_key) : processor_.CompareKeys(key, last_key) == 0)) {
+			if (IsUnique()) {
+				ok = false;
+				break;
+			}
+			rids.push_back(value);
+			continue;
+		}
+		if (!rids.empty()) {
+			BulkLoadEntry(levels, last_key, rids);
+			loaded++;
+		}
+		memcpy(last_key, key, processor_.GetKeySize());
+		rids.assign(1, value);
+	}
+	if (ok && !rids.empty()) {
+		BulkLoadEntry(levels, last_key, rids);
+		loaded++;
+	}
+	free(last_key);
+	ASSERT(!ok || loaded == count, "Sorter returned fewer entries than it was given.");
+
+	if (!ok) { // 丢弃已经建好的页
+		for (auto &level : levels) {
+			if (level.page_ != nullptr) {
+				buffer_pool_manager_->UnpinPage(level.page_->GetPageId(), false);
+			}
+			for (auto page_id : level.pages_) {
+				buffer_pool_manager_->DeletePage(page_id);
+			}
+		}
+		root_page_id_ = INVALID_PAGE_ID;
+		root_latch_.WUnlock();
+		return false;
+	}
+	UpdateRootPageId(1);
+	root_latch_.WUnlock();
+	return true;
+}
+
+void BPlusTree::BulkLoadEntry(std::vector<BulkLoadLevel> &levels, GenericKey *key, std::vector<RowId> &rids) {
+	if (levels[0].page_ == nullptr) {
+		BulkLoadNewPage(levels, 0);
+	}
+	LeafPage *leaf_node = reinterpret_cast<LeafPage *>(levels[0].page_->GetData());
+	int index = leaf_node->GetSize();
+	leaf_node->SetKeyAt(index, key);
+	if (IsUnique()) {
+		leaf_node->SetValueAt(index, rids[0]);
+	} else {
+		std::sort(rids.begin(), rids.end()); // sorter 只按 key 排序
+		PostingBuild(leaf_node, index, rids);
+	}
+	leaf_node->IncreaseSize(1);
+	if (leaf_node->GetSize() == levels[0].quota_) {
+		BulkLoadComplete(levels, 0);
+	}
+}
+
+BPlusTree::BulkLoadLevel BPlusTree::PlanLevel(size_t entries, int capacity, int min_size, double fill_factor) {
+	// pages fill_factor full, but never over capacity and, unless there is only one, never under min size
+	int target = std::min(capacity, std::max(std::max(min_size, 1), static_cast<int>(capacity * fill_factor)));
+	size_t nodes = (entries + target - 1) / target;
+	if (min_size > 0 && nodes > 1) {
+		nodes = std::max<size_t>(1, std::min(nodes, entries / min_size));
+	}
+	BulkLoadLevel level;
+	level.nodes_ = nodes;
+	level.base_size_ = static_cast<int>(entries / nodes);
+	level.extra_ = entries % nodes;
+	level.pages_.reserve(nodes);
+	return level;
+}
+
+Page *BPlusTree::BulkLoadNewPage(std::vector<BulkLoadLevel> &levels, size_t level) {
+	BulkLoadLevel &plan = levels[level];
+	ASSERT(plan.pages_.size() < plan.nodes_, "Bulk load level has more pages than planned.");
+	page_id_t new_page_id = INVALID_PAGE_ID;
+	page_id_t near_page_id = plan.pages_.empty() ? INVALID_PAGE_ID : plan.pages_.back();
+	Page *new_page = buffer_pool_manager_->NewPage(new_page_id, near_page_id);
+	if (new_page == nullptr) {
+		throw std::runtime_error("out of memory");
+	}
+	if (level == 0) {
+		reinterpret_cast<LeafPage *>(new_page->GetData())
+				->Init(new_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_, value_size_);
+	} else {
+		reinterpret_cast<InternalPage *>(new_page->GetData())
+				->Init(new_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+	}
+	plan.quota_ = plan.base_size_ + (plan.pages_.size() < plan.extra_ ? 1 : 0);
+	plan.pages_.push_back(new_page_id);
+	plan.page_ = new_page;
+	return new_page;
+}
+
+page_id_t BPlusTree::BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, GenericKey *key,
+                                    page_id_t child) {
+	if (levels[level].page_ == nullptr) {
+		BulkLoadNewPage(levels, level);
+	}
+	InternalPage *node = reinterpret_cast<InternalPage *>(levels[level].page_->GetData());
+	int index = node->GetSize();
+	node->SetKeyAt(index, key); // kvp[0].key 不参与查找，存子树的最小 key 供上一层使用
+	ToSeparator(node->KeyAt(index));
+	node->SetValueAt(index, child);
+	node->IncreaseSize(1);
+	page_id_t page_id = node->GetPageId();
+	if (node->GetSize() == levels[level].quota_) {
+		BulkLoadComplete(levels, level);
+	}
+	return page_id;
+}
+
+void BPlusTree::BulkLoadComplete(std::vector<BulkLoadLevel> &levels, size_t level) {
+	Page *page = levels[level].page_;
+	BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+	levels[level].page_ = nullptr;
+	if (level == 0 && levels[0].pages_.size() < levels[0].nodes_) { // 先开下一个叶子，链上 next_page_id
+		Page *next_page = BulkLoadNewPage(levels, 0);
+		reinterpret_cast<LeafPage *>(node)->SetNextPageId(next_page->GetPageId());
+	}
+	GenericKey *first_key = level == 0 ? reinterpret_cast<LeafPage *>(node)->KeyAt(0)
+	                                   : reinterpret_cast<InternalPage *>(node)->KeyAt(0);
+	if (level + 1 < levels.size()) {
+		node->SetParentPageId(BulkLoadAppend(levels, level + 1, first_key, page->GetPageId()));
+	} else {
+		root_page_id_ = page->GetPageId();
+	}
+	buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -226,20 +437,72 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * necessary.
  */
 void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
-	if (IsEmpty()) {
-		return;
+	RemoveEntry(key, nullptr, transaction);
+}
+
+/*
+ * Delete one key & value pair. A key of a non-unique tree stays as long as it
+ * has other values, the key goes with its last value.
+ * @return: false if the pair does not exist
+ */
+bool BPlusTree::Remove(const GenericKey *key, const RowId &value, Transaction *transaction) {
+	return RemoveEntry(key, &value, transaction);
+}
+
+bool BPlusTree::RemoveEntry(const GenericKey *key, const RowId *value, Transaction *transaction) {
+	std::vector<Page *> path;
+	bool root_locked = false;
+	bool removed = false;
+	// 乐观：只删一个 RowId，或者叶子删除后不会低于 min size 就直接删除
+	Page *leaf_page = FindLeafPage(key, LatchMode::kOptimistic, path, root_locked);
+	if (leaf_page == nullptr) {
+		return false;
 	}
-	Page *leaf_page = FindLeafPage(key);
 	LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-	int old_size = leaf_node->GetSize();
-	int new_size = leaf_node->RemoveAndDeleteRecord(key, processor_);
-	if (old_size == new_size) {
-		buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
-	} else {
+	int index = RemoveValues(leaf_node, key, value, removed);
+	if (index < 0 || IsSafe(leaf_node, LatchMode::kRemove)) {
+		if (index >= 0) {
+			PostingFree(leaf_node, index);
+			leaf_node->RemoveByIndex(index);
+			removed = true;
+		}
+		ReleaseLatches(path, root_locked, true, removed);
+		return removed;
+	}
+	ReleaseLatches(path, root_locked, true, false);
+	// 悲观：写锁下降，只保留可能合并的那段路径
+	leaf_page = FindLeafPage(key, LatchMode::kRemove, path, root_locked);
+	if (leaf_page == nullptr) {
+		ReleaseLatches(path, root_locked, true, false);
+		return false;
+	}
+	leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+	index = RemoveValues(leaf_node, key, value, removed); // 放锁期间可能被别人改过
+	if (index >= 0) {
+		PostingFree(leaf_node, index);
+		leaf_node->RemoveByIndex(index);
+		removed = true;
 		CoalesceOrRedistribute(leaf_node, transaction);
-		buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
 	}
-	return;
+	ReleaseLatches(path, root_locked, true, removed);
+	return removed;
+}
+
+int BPlusTree::RemoveValues(LeafPage *node, const GenericKey *key, const RowId *value, bool &removed) {
+	removed = false;
+	int index = node->KeyIndex(key, processor_);
+	if (index >= node->GetSize() || processor_.CompareKeys(key, node->KeyAt(index)) != 0) {
+		return -1;
+	}
+	if (value == nullptr) {
+		return index;
+	}
+	RowId *values = node->ValuesAt(index);
+	if (PostingPage::RowIdCount(values, value_size_ / sizeof(RowId)) > 1) { // key 还有别的 RowId，留下
+		removed = PostingRemove(node, index, *value);
+		return -1;
+	}
+	return values[0] == *value ? index : -1;
 }
 
 /* todo 合并 或 再分配
@@ -271,6 +534,7 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
 	page_id_t neighbor_page_id = parent_node->ValueAt(neighbor_index);
 	Page *neighbor_page = buffer_pool_manager_->FetchPage(neighbor_page_id);
 	if (neighbor_page != nullptr) {
+		neighbor_page->WLatch(); // 兄弟不在下降路径上，父节点的写锁挡住了其它从上面来的线程
 		N* neighbor_node = reinterpret_cast<N *>(neighbor_page->GetData());
 		if (node->GetSize() + neighbor_node->GetSize() >= node->GetMaxSize()) { // Redistribute
 			Redistribute(neighbor_node, node, node_index);
@@ -279,6 +543,7 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
 			Coalesce(neighbor_node, node, parent_node, node_index, transaction);
 			flag = true;
 		}
+		neighbor_page->WUnlatch();
 		buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
 		buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
 	}
@@ -348,9 +613,11 @@ void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index)
 		if (index == 0) {
 			neighbor_node->MoveFirstToEndOf(node);
 			parent_node->SetKeyAt(1, neighbor_node->KeyAt(0));
+			ToSeparator(parent_node->KeyAt(1));
 		} else {
 			neighbor_node->MoveLastToFrontOf(node);
 			parent_node->SetKeyAt(index, node->KeyAt(0));
+			ToSeparator(parent_node->KeyAt(index));
 		}
 		buffer_pool_manager_->UnpinPage(parent_node->GetPageId(), true);
 	}
@@ -405,6 +672,192 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
 	return flag;
 }
 
+/*****************************************************************************
+ * POSTING LIST
+ *****************************************************************************/
+bool BPlusTree::PostingInsert(LeafPage *node, int index, const RowId &value) {
+	RowId *values = node->ValuesAt(index);
+	int slots = value_size_ / sizeof(RowId);
+	if (!PostingPage::IsPostingList(values)) {
+		int count = PostingPage::RowIdCount(values, slots);
+		RowId *pos = std::lower_bound(values, values + count, value);
+		if (pos != values + count && *pos == value) {
+			return false;
+		}
+		if (count < slots) {
+			std::copy_backward(pos, values + count, values + count + 1);
+			*pos = value;
+			return true;
+		}
+		// 叶子里放不下了，搬到 posting page
+		std::vector<RowId> rids(values, values + count);
+		rids.insert(rids.begin() + (pos - values), value);
+		PostingBuild(node, index, rids);
+		return true;
+	}
+	// 新行的 RowId 一般最大，先看最后一页，不行再从头找第一个最大值不小于 value 的页
+	page_id_t page_id = values[1].GetPageId();
+	Page *page = buffer_pool_manager_->FetchPage(page_id);
+	PostingPage *posting_node = reinterpret_cast<PostingPage *>(page->GetData());
+	if (!(posting_node->RowIdAt(posting_node->GetSize() - 1) < value)) {
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		page_id = values[0].GetPageId();
+		while (true) {
+			page = buffer_pool_manager_->FetchPage(page_id);
+			posting_node = reinterpret_cast<PostingPage *>(page->GetData());
+			if (!(posting_node->RowIdAt(posting_node->GetSize() - 1) < value) ||
+			    posting_node->GetNextPageId() == INVALID_PAGE_ID) {
+				break;
+			}
+			buffer_pool_manager_->UnpinPage(page_id, false);
+			page_id = posting_node->GetNextPageId();
+		}
+	}
+	int pos = posting_node->RowIdIndex(value);
+	if (pos < posting_node->GetSize() && posting_node->RowIdAt(pos) == value) {
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		return false;
+	}
+	if (posting_node->IsFull()) { // 分裂，后一半搬到新页
+		page_id_t new_page_id = INVALID_PAGE_ID;
+		Page *new_page = buffer_pool_manager_->NewPage(new_page_id, page_id);
+		if (new_page == nullptr) {
+			buffer_pool_manager_->UnpinPage(page_id, false);
+			throw std::runtime_error("out of memory");
+		}
+		PostingPage *new_node = reinterpret_cast<PostingPage *>(new_page->GetData());
+		new_node->Init(new_page_id);
+		posting_node->MoveHalfTo(new_node);
+		new_node->SetNextPageId(posting_node->GetNextPageId());
+		posting_node->SetNextPageId(new_page_id);
+		if (values[1].GetPageId() == page_id) {
+			values[1] = RowId(new_page_id, values[1].GetSlotNum());
+		}
+		if (value < new_node->RowIdAt(0)) {
+			posting_node->Insert(value);
+		} else {
+			new_node->Insert(value);
+		}
+		buffer_pool_manager_->UnpinPage(new_page_id, true);
+	} else {
+		posting_node->Insert(value);
+	}
+	buffer_pool_manager_->UnpinPage(page_id, true);
+	values[1] = RowId(values[1].GetPageId(), values[1].GetSlotNum() + 1);
+	return true;
+}
+
+bool BPlusTree::PostingRemove(LeafPage *node, int index, const RowId &value) {
+	RowId *values = node->ValuesAt(index);
+	int slots = value_size_ / sizeof(RowId);
+	if (!PostingPage::IsPostingList(values)) {
+		int count = PostingPage::RowIdCount(values, slots);
+		RowId *pos = std::lower_bound(values, values + count, value);
+		if (pos == values + count || !(*pos == value)) {
+			return false;
+		}
+		std::copy(pos + 1, values + count, pos);
+		values[count - 1] = INVALID_ROWID;
+		return true;
+	}
+	page_id_t prev_page_id = INVALID_PAGE_ID;
+	page_id_t page_id = values[0].GetPageId();
+	Page *page = nullptr;
+	PostingPage *posting_node = nullptr;
+	while (true) {
+		page = buffer_pool_manager_->FetchPage(page_id);
+		posting_node = reinterpret_cast<PostingPage *>(page->GetData());
+		if (!(posting_node->RowIdAt(posting_node->GetSize() - 1) < value) ||
+		    posting_node->GetNextPageId() == INVALID_PAGE_ID) {
+			break;
+		}
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		prev_page_id = page_id;
+		page_id = posting_node->GetNextPageId();
+	}
+	if (!posting_node->Remove(value)) {
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		return false;
+	}
+	page_id_t next_page_id = posting_node->GetNextPageId();
+	bool empty = posting_node->GetSize() == 0;
+	buffer_pool_manager_->UnpinPage(page_id, true);
+	uint32_t count = values[1].GetSlotNum() - 1;
+	page_id_t last_page_id = values[1].GetPageId();
+	if (empty) { // 空页从链上摘掉
+		if (prev_page_id == INVALID_PAGE_ID) {
+			values[0] = RowId(next_page_id, POSTING_LIST_SLOT);
+		} else {
+			Page *prev_page = buffer_pool_manager_->FetchPage(prev_page_id);
+			reinterpret_cast<PostingPage *>(prev_page->GetData())->SetNextPageId(next_page_id);
+			buffer_pool_manager_->UnpinPage(prev_page_id, true);
+		}
+		if (last_page_id == page_id) {
+			last_page_id = prev_page_id;
+		}
+		buffer_pool_manager_->DeletePage(page_id);
+	}
+	values[1] = RowId(last_page_id, count);
+	if (static_cast<int>(count) < slots) { // 少到放得下就搬回叶子
+		std::vector<RowId> rids;
+		PostingPage::CollectRowIds(values, slots, buffer_pool_manager_, rids);
+		PostingFree(node, index);
+		PostingBuild(node, index, rids);
+	}
+	return true;
+}
+
+void BPlusTree::PostingBuild(LeafPage *node, int index, const std::vector<RowId> &rids) {
+	RowId *values = node->ValuesAt(index);
+	int slots = value_size_ / sizeof(RowId);
+	std::fill(values, values + slots, INVALID_ROWID);
+	if (static_cast<int>(rids.size()) <= slots) {
+		std::copy(rids.begin(), rids.end(), values);
+		return;
+	}
+	// 每页写满，链上的页按 RowId 排好
+	page_id_t first_page_id = INVALID_PAGE_ID;
+	page_id_t last_page_id = INVALID_PAGE_ID;
+	PostingPage *last_node = nullptr;
+	for (size_t i = 0; i < rids.size(); i += PostingPage::MAX_SIZE) {
+		page_id_t page_id = INVALID_PAGE_ID;
+		Page *page = buffer_pool_manager_->NewPage(page_id, last_node == nullptr ? node->GetPageId() : last_page_id);
+		if (page == nullptr) {
+			throw std::runtime_error("out of memory");
+		}
+		PostingPage *posting_node = reinterpret_cast<PostingPage *>(page->GetData());
+		posting_node->Init(page_id);
+		posting_node->Append(rids.data() + i, std::min<int>(PostingPage::MAX_SIZE, rids.size() - i));
+		if (last_node == nullptr) {
+			first_page_id = page_id;
+		} else {
+			last_node->SetNextPageId(page_id);
+			buffer_pool_manager_->UnpinPage(last_page_id, true);
+		}
+		last_node = posting_node;
+		last_page_id = page_id;
+	}
+	buffer_pool_manager_->UnpinPage(last_page_id, true);
+	values[0] = RowId(first_page_id, POSTING_LIST_SLOT);
+	values[1] = RowId(last_page_id, static_cast<uint32_t>(rids.size()));
+}
+
+void BPlusTree::PostingFree(LeafPage *node, int index) {
+	RowId *values = node->ValuesAt(index);
+	if (IsUnique() || !PostingPage::IsPostingList(values)) {
+		return;
+	}
+	page_id_t page_id = values[0].GetPageId();
+	while (page_id != INVALID_PAGE_ID) {
+		Page *page = buffer_pool_manager_->FetchPage(page_id);
+		page_id_t next_page_id = reinterpret_cast<PostingPage *>(page->GetData())->GetNextPageId();
+		buffer_pool_manager_->UnpinPage(page_id, false);
+		buffer_pool_manager_->DeletePage(page_id);
+		page_id = next_page_id;
+	}
+	std::fill(values, values + value_size_ / sizeof(RowId), INVALID_ROWID);
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -416,7 +869,9 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
 IndexIterator BPlusTree::Begin() {
 	GenericKey *key;
 	Page *left_most_leaf_page = FindLeafPage(key, -1, true);
-  	return IndexIterator(left_most_leaf_page->GetPageId(), buffer_pool_manager_, 0);
+	IndexIterator iter(left_most_leaf_page->GetPageId(), buffer_pool_manager_, 0);
+	buffer_pool_manager_->UnpinPage(left_most_leaf_page->GetPageId(), false); // iterator 自己 pin 了一次
+	return iter;
 }
 
 /*
@@ -425,9 +880,19 @@ IndexIterator BPlusTree::Begin() {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-	Page *leaf_page = FindLeafPage(key);
+	std::vector<Page *> path;
+	bool root_locked = false;
+	Page *leaf_page = FindLeafPage(key, LatchMode::kRead, path, root_locked);
 	LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-   	return IndexIterator(leaf_page->GetPageId(), buffer_pool_manager_, leaf_node->KeyIndex(key, processor_));
+	int index = leaf_node->KeyIndex(key, processor_);
+	page_id_t page_id = leaf_page->GetPageId();
+	if (index == leaf_node->GetSize() && leaf_node->GetNextPageId() != INVALID_PAGE_ID) { // key 比这个叶子都大，从下一个叶子开始
+		page_id = leaf_node->GetNextPageId();
+		index = 0;
+	}
+	IndexIterator iter(page_id, buffer_pool_manager_, index);
+	ReleaseLatches(path, root_locked, false, false);
+	return iter;
 }
 
 /*
@@ -436,19 +901,27 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::End() {
+	root_latch_.RLock();
 	Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+	page->RLatch();
+	root_latch_.RUnlock();
 	BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 	while (!node->IsLeafPage()) {
 		InternalPage *parent_node = reinterpret_cast<InternalPage *>(node);
 		page_id_t child_page_id = parent_node->ValueAt(parent_node->GetSize() - 1); // right most
 		Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+		child_page->RLatch();
 		BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+		page->RUnlatch();
 		buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
 		page = child_page;
 		node = child_node;
 	} 
 	LeafPage *end_node = reinterpret_cast<LeafPage *>(page->GetData());
-	return IndexIterator(page->GetPageId(), buffer_pool_manager_, end_node->GetSize());
+	IndexIterator iter(page->GetPageId(), buffer_pool_manager_, end_node->GetSize());
+	page->RUnlatch();
+	buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+	return iter;
 }
 
 /*****************************************************************************
@@ -460,30 +933,160 @@ IndexIterator BPlusTree::End() {
  * Note: the leaf page is pinned, you need to unpin it after use.
  */
 Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
+	if (page_id != INVALID_PAGE_ID) {
+		return buffer_pool_manager_->FetchPage(page_id);
+	}
+	std::vector<Page *> path;
+	bool root_locked = false;
+	Page *page = FindLeafPage(key, LatchMode::kRead, path, root_locked, leftMost);
+	if (page != nullptr) {
+		page->RUnlatch(); // 只留 pin 给调用者
+	}
+	return page;
+}
+
+/*
+ * Latch crabbing: a child is latched before the latch of its parent is let go.
+ * kRead and kOptimistic release the parent right away (kOptimistic write
+ * latches the leaf only). kInsert and kRemove write latch every page and keep
+ * the latches of the ancestors (and root_latch_) until they meet a page that is
+ * safe, i.e. will not split or merge whatever happens below it.
+ * Note: the latched pages end up in `path`, pinned; release them with
+ * ReleaseLatches. Returns nullptr for an empty tree, with root_latch_ still
+ * held in write mode for kInsert and kRemove.
+ */
+Page *BPlusTree::FindLeafPage(const GenericKey *key, LatchMode mode, std::vector<Page *> &path, bool &root_locked,
+                              bool leftMost) {
+	bool write = mode == LatchMode::kInsert || mode == LatchMode::kRemove;
+	if (write) {
+		root_latch_.WLock();
+	} else {
+		root_latch_.RLock();
+	}
+	root_locked = true;
 	if (IsEmpty()) {
+		if (!write) {
+			root_latch_.RUnlock();
+			root_locked = false;
+		}
 		return nullptr;
 	}
-	if (page_id != -1) {
-		return buffer_pool_manager_->FetchPage(page_id);
+	Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+	BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+	LatchPage(page, mode, node->IsLeafPage());
+	// 根的 id 只会被拿着根写锁的线程改
+	if (!write) {
+		root_latch_.RUnlock();
+		root_locked = false;
+	}
+	if (write && IsSafe(node, mode)) {
+		root_latch_.WUnlock();
+		root_locked = false;
+	}
+	path.push_back(page);
+	while (!node->IsLeafPage()) {
+		InternalPage *parent_node = reinterpret_cast<InternalPage *>(node);
+		page_id_t child_page_id = leftMost ? parent_node->ValueAt(0) : parent_node->Lookup(key, processor_);
+		Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+		BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+		LatchPage(child_page, mode, child_node->IsLeafPage());
+		if (!write || IsSafe(child_node, mode)) { // 放掉上面所有的锁
+			ReleaseLatches(path, root_locked, write, false);
+		}
+		path.push_back(child_page);
+		page = child_page;
+		node = child_node;
+	}
+	return page;
+}
+
+/*
+ * Like the kRead descent, and on the way down remember the key right of the
+ * child taken: the deepest one is the tightest upper bound of the leaf.
+ */
+Page *BPlusTree::FindLeafPageForScan(const GenericKey *key, GenericKey *high_key, bool &has_high_key) {
+	has_high_key = false;
+	root_latch_.RLock();
+	if (IsEmpty()) {
+		root_latch_.RUnlock();
+		return nullptr;
+	}
+	Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+	page->RLatch();
+	root_latch_.RUnlock();
+	BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+	while (!node->IsLeafPage()) {
+		InternalPage *parent_node = reinterpret_cast<InternalPage *>(node);
+		int index = key == nullptr ? 0 : parent_node->ValueIndex(parent_node->Lookup(key, processor_));
+		if (index + 1 < parent_node->GetSize()) {
+			memcpy(high_key, parent_node->KeyAt(index + 1), processor_.GetKeySize());
+			has_high_key = true;
+		}
+		Page *child_page = buffer_pool_manager_->FetchPage(parent_node->ValueAt(index));
+		child_page->RLatch();
+		page->RUnlatch();
+		buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+		page = child_page;
+		node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+	}
+	return page;
+}
+
+void BPlusTree::LatchPage(Page *page, LatchMode mode, bool is_leaf) {
+	if (mode == LatchMode::kRead || (mode == LatchMode::kOptimistic && !is_leaf)) {
+		page->RLatch();
 	} else {
-		Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-		BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
-		while (!node->IsLeafPage()) {
-			InternalPage *parent_node = reinterpret_cast<InternalPage *>(node);
-			page_id_t child_page_id = -1;
-			if (leftMost) {
-				child_page_id = parent_node->ValueAt(0);
-			} else {
-				child_page_id = parent_node->Lookup(key, processor_);
-			}
-			Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
-			BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-			buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-			page = child_page;
-			node = child_node;
+		page->WLatch();
+	}
+}
+
+/*
+ * A page is safe if the operation can not spread to its parent:
+ * an insert does not split it, a remove does not make it merge or shrink the root.
+ */
+bool BPlusTree::IsSafe(BPlusTreePage *node, LatchMode mode) {
+	if (mode == LatchMode::kInsert) {
+		// 叶子在 size > max 时分裂，内部节点在 size >= max 时分裂
+		return node->IsLeafPage() ? node->GetSize() < node->GetMaxSize() : node->GetSize() < node->GetMaxSize() - 1;
+	}
+	if (mode == LatchMode::kRemove) {
+		if (node->IsRootPage()) {
+			return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+		}
+		return node->GetSize() > node->GetMinSize();
+	}
+	return true;
+}
+
+bool BPlusTree::IsDuplicate(const GenericKey *lhs, const GenericKey *rhs) const {
+	if (key_column_count_ == 0) {
+		return processor_.CompareKeys(lhs, rhs) == 0;
+	}
+	return processor_.ComparePrefixEquals(lhs, rhs, key_column_count_);
+}
+
+void BPlusTree::ToSeparator(GenericKey *key) const {
+	// 左边叶子的最后一个 key 的 key 列不同，比截断后的 key 小，分隔仍然成立
+	if (key_column_count_ > 0) {
+		processor_.TruncateToPrefix(key, key_column_count_);
+	}
+}
+
+void BPlusTree::ReleaseLatches(std::vector<Page *> &path, bool &root_locked, bool write, bool is_dirty) {
+	if (root_locked) {
+		root_latch_.WUnlock(); // 只有写操作会在下降后还拿着 root_latch_
+		root_locked = false;
+	}
+	for (auto page : path) {
+		// kOptimistic 在这里只剩写锁的叶子
+		if (write) {
+			page->WUnlatch();
+		} else {
+			page->RUnlatch();
 		}
-		return page;
+		buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
 	}
+	path.clear();
 }
 
 /*
@@ -498,11 +1101,11 @@ void BPlusTree::UpdateRootPageId(int insert_record) {
 	Page *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
 	if (header_page != nullptr) {
 		IndexRootsPage *header_node = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
-		if (insert_record == 0) {
+		header_page->WLatch(); // 所有索引共用这一页
+		if (insert_record == 0 || !header_node->Insert(index_id_, root_page_id_)) { // 删空过的树已经有记录
 			header_node->Update(index_id_, root_page_id_);
-		} else {
-			header_node->Insert(index_id_, root_page_id_);
 		}
+		header_page->WUnlatch();
 		buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 	}
 }
@@ -0,0 +1,116 @@
+#include "index/b_plus_tree_cursor.h"
+
+#include <cstring>
+
+BPlusTreeCursor::BPlusTreeCursor(BPlusTree *tree, const GenericKey *lower, bool lower_inclusive,
+                                 const GenericKey *upper, bool upper_inclusive, Schema *key_schema)
+    : tree_(tree),
+      processor_(tree->processor_),
+      upper_inclusive_(upper_inclusive),
+      probe_inclusive_(lower_inclusive),
+      high_key_(tree->processor_.InitKey()),
+      key_schema_(key_schema) {
+  if (lower != nullptr) {
+    probe_ = processor_.InitKey();
+    memcpy(probe_, lower, processor_.GetKeySize());
+  }
+  if (upper != nullptr) {
+    upper_ = processor_.InitKey();
+    memcpy(upper_, upper, processor_.GetKeySize());
+  }
+}
+
+BPlusTreeCursor::~BPlusTreeCursor() {
+  free(probe_);
+  free(upper_);
+  free(high_key_);
+}
+
+bool BPlusTreeCursor::Next(RowId &rid) {
+  if (batch_index_ == batch_.size() && !FetchBatch()) {
+    return false;
+  }
+  rid = batch_[batch_index_++];
+  return true;
+}
+
+bool BPlusTreeCursor::Next(RowId &rid, Row &key) {
+  ASSERT(key_schema_ != nullptr, "Cursor opened without keys.");
+  if (!Next(rid)) {
+    return false;
+  }
+  key.destroy();
+  size_t key_size = processor_.GetKeySize();
+  processor_.DeserializeToKey(reinterpret_cast<const GenericKey *>(batch_keys_.data() + (batch_index_ - 1) * key_size),
+                              key, key_schema_);
+  key.SetRowId(rid);
+  return true;
+}
+
+bool BPlusTreeCursor::PastUpper(const GenericKey *key) const {
+  if (upper_ == nullptr) {
+    return false;
+  }
+  int cmp = processor_.CompareKeys(key, upper_);
+  return cmp > 0 || (cmp == 0 && !upper_inclusive_);
+}
+
+bool BPlusTreeCursor::FetchBatch() {
+  batch_.clear();
+  batch_keys_.clear();
+  batch_index_ = 0;
+  // a leaf may have no key left in range, e.g. emptied by deletes, so go on until something is found
+  while (batch_.empty() && !done_) {
+    bool has_high_key;
+    Page *page = tree_->FindLeafPageForScan(probe_, high_key_, has_high_key);
+    if (page == nullptr) {
+      done_ = true;
+      break;
+    }
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+    int index = 0;
+    if (probe_ != nullptr) {
+      index = leaf->KeyIndex(probe_, processor_);
+      if (!probe_inclusive_) {
+        while (index < leaf->GetSize() && processor_.CompareKeys(leaf->KeyAt(index), probe_) == 0) {
+          index++;
+        }
+      }
+    }
+    int slots = leaf->GetValueSize() / static_cast<int>(sizeof(RowId));
+    for (; index < leaf->GetSize(); index++) {
+      if (PastUpper(leaf->KeyAt(index))) {
+        done_ = true;
+        break;
+      }
+      size_t old_size = batch_.size();
+      if (slots == 1) {
+        batch_.emplace_back(leaf->ValueAt(index));
+      } else {
+        BPlusTreePostingPage::CollectRowIds(leaf->ValuesAt(index), slots, tree_->buffer_pool_manager_, batch_);
+      }
+      if (key_schema_ != nullptr) {
+        const char *key = reinterpret_cast<const char *>(leaf->KeyAt(index));
+        for (size_t i = old_size; i < batch_.size(); i++) {
+          batch_keys_.insert(batch_keys_.end(), key, key + processor_.GetKeySize());
+        }
+      }
+    }
+    page->RUnlatch();
+    tree_->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (done_) {
+      break;
+    }
+    // every key of the following leaves is at least the separator
+    if (!has_high_key || PastUpper(high_key_)) {
+      done_ = true;
+      break;
+    }
+    if (probe_ == nullptr) {
+      probe_ = processor_.InitKey();
+    }
+    memcpy(probe_, high_key_, processor_.GetKeySize());
+    probe_inclusive_ = true;
+  }
+  return !batch_.empty();
+}
@@ -4,10 +4,11 @@
 #include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
-    : Index(index_id, key_schema),
-      processor_(key_schema_, key_size),
-      container_(index_id, buffer_pool_manager, processor_) {}
+                               BufferPoolManager *buffer_pool_manager, bool unique, uint32_t include_count)
+    : Index(index_id, key_schema, include_count, unique),
+      processor_(key_schema_, KeyManager::FitKeySize(key_size)),
+      container_(index_id, buffer_pool_manager, processor_, UNDEFINED_SIZE, UNDEFINED_SIZE, unique,
+                 include_count > 0 ? GetKeyColumnCount() : 0) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
@@ -31,49 +32,80 @@ dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *t
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
 
-  container_.Remove(index_key, txn);
+  bool status = container_.Remove(index_key, row_id, txn);
   delete index_key;
+  if (!status) {
+    return DB_KEY_NOT_FOUND;
+  }
   return DB_SUCCESS;
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
-  GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
-  if (compare_operator == "=") {
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn))
-      ++iter;
-    for (; iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
+  // the tree keys with the key columns of `key` are those from `low` to `high`, one key without included columns
+  GenericKey *low = processor_.InitKey();
+  GenericKey *high = processor_.InitKey();
+  processor_.SerializeFromKey(low, key, GetKeyColumnCount(), KeyManager::KEY_FILL_LOW);
+  processor_.SerializeFromKey(high, key, GetKeyColumnCount(), KeyManager::KEY_FILL_HIGH);
+  size_t old_size = result.size();
+  auto drain = [&result](BPlusTreeCursor &&cursor) {
+    RowId rid;
+    while (cursor.Next(rid)) {
+      result.emplace_back(rid);
     }
+  };
+  if (compare_operator == "=" && include_count_ == 0) {
+    container_.GetValue(low, result, txn);
+  } else if (compare_operator == "=") {
+    drain(BPlusTreeCursor(&container_, low, true, high, true));
+  } else if (compare_operator == ">") {
+    drain(BPlusTreeCursor(&container_, high, false, nullptr, false));
   } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
+    drain(BPlusTreeCursor(&container_, low, true, nullptr, false));
   } else if (compare_operator == "<") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
-    }
+    drain(BPlusTreeCursor(&container_, nullptr, false, low, false));
   } else if (compare_operator == "<=") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    container_.GetValue(index_key, result, txn);
+    drain(BPlusTreeCursor(&container_, nullptr, false, high, true));
   } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
+    drain(BPlusTreeCursor(&container_, nullptr, false, low, false));
+    drain(BPlusTreeCursor(&container_, high, false, nullptr, false));
   }
-  delete index_key;
-  if (!result.empty())
-    return DB_SUCCESS;
-  else
-    return DB_KEY_NOT_FOUND;
+  free(low);
+  free(high);
+  return result.size() > old_size ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+std::unique_ptr<IndexCursor> BPlusTreeIndex::OpenCursor(const std::vector<Field> &prefix, const Field *lower,
+                                                        bool lower_inclusive, const Field *upper,
+                                                        bool upper_inclusive, [[maybe_unused]] Transaction *txn,
+                                                        bool with_keys) {
+  ASSERT(prefix.size() + (lower != nullptr || upper != nullptr) <= key_schema_->GetColumnCount(),
+         "Index scan bounds more columns than the key has.");
+  GenericKey *low = processor_.InitKey();
+  GenericKey *high = processor_.InitKey();
+  processor_.SerializeRangeToKeys(low, high, prefix, lower, lower_inclusive, upper, upper_inclusive);
+  auto cursor =
+      std::make_unique<BPlusTreeCursor>(&container_, low, true, high, false, with_keys ? key_schema_ : nullptr);
+  free(low);
+  free(high);
+  return cursor;
+}
+
+dberr_t BPlusTreeIndex::BulkLoad(TableHeap *table_heap, Schema *table_schema, Transaction *txn, double fill_factor) {
+  KeySorter sorter(processor_);
+  GenericKey *index_key = processor_.InitKey();
+  BufferRing ring;
+  for (auto iter = table_heap->Begin(txn, &ring); iter != table_heap->End(); ++iter) {
+    Row key_row;
+    iter->GetKeyFromRow(table_schema, key_schema_, key_row);
+    processor_.SerializeFromKey(index_key, key_row, key_schema_);
+    sorter.Add(index_key, iter->GetRowId());
+  }
+  free(index_key);
+  sorter.Finish();
+  if (!container_.BulkLoad(sorter, fill_factor, txn)) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
 }
 
 dberr_t BPlusTreeIndex::Destroy() {
@@ -0,0 +1,568 @@
+#include "index/extendible_hash_index.h"
+
+#include <algorithm>
+
+#include "page/index_roots_page.h"
+
+/** Hash bits a bucket can be split by at most, one per level of the largest directory. */
+static constexpr uint64_t HASH_DIRECTORY_MAX_MASK = (1ULL << HASH_DIRECTORY_MAX_DEPTH) - 1;
+
+ExtendibleHashIndex::ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                                         BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema, 0, unique),
+      processor_(key_schema_, KeyManager::FitKeySize(key_size)),
+      buffer_pool_manager_(buffer_pool_manager) {
+  Page *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto *roots = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
+  header_page->RLatch();
+  page_id_t directory_page_id;
+  if (roots->GetRootId(index_id_, &directory_page_id)) {
+    directory_page_id_ = directory_page_id;
+  }
+  header_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+dberr_t ExtendibleHashIndex::InsertEntry(const Row &key, RowId row_id, [[maybe_unused]] Transaction *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  latch_.WLock();
+  bool status = Insert(index_key, row_id);
+  latch_.WUnlock();
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t ExtendibleHashIndex::RemoveEntry(const Row &key, RowId row_id, [[maybe_unused]] Transaction *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  latch_.WLock();
+  bool status = Remove(index_key, row_id);
+  latch_.WUnlock();
+  free(index_key);
+  return status ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t ExtendibleHashIndex::ScanKey(const Row &key, vector<RowId> &result, [[maybe_unused]] Transaction *txn,
+                                     string compare_operator) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  size_t old_size = result.size();
+  latch_.RLock();
+  if (compare_operator == "=") {
+    GetValue(index_key, result);
+  } else {
+    // keys compare like their rows, see GenericKey, so any operator can filter the buckets
+    std::function<bool(int)> accept;
+    if (compare_operator == ">") {
+      accept = [](int cmp) { return cmp > 0; };
+    } else if (compare_operator == ">=") {
+      accept = [](int cmp) { return cmp >= 0; };
+    } else if (compare_operator == "<") {
+      accept = [](int cmp) { return cmp < 0; };
+    } else if (compare_operator == "<=") {
+      accept = [](int cmp) { return cmp <= 0; };
+    } else if (compare_operator == "<>") {
+      accept = [](int cmp) { return cmp != 0; };
+    }
+    if (accept) {
+      Scan([&](const GenericKey *k) { return accept(processor_.CompareKeys(k, index_key)); }, result);
+    }
+  }
+  latch_.RUnlock();
+  free(index_key);
+  return result.size() > old_size ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+std::unique_ptr<IndexCursor> ExtendibleHashIndex::OpenCursor(const std::vector<Field> &prefix, const Field *lower,
+                                                             bool lower_inclusive, const Field *upper,
+                                                             bool upper_inclusive, [[maybe_unused]] Transaction *txn,
+                                                             bool with_keys) {
+  ASSERT(prefix.size() + (lower != nullptr || upper != nullptr) <= key_schema_->GetColumnCount(),
+         "Index scan bounds more columns than the key has.");
+  std::vector<RowId> result;
+  std::vector<char> keys;
+  GenericKey *low = processor_.InitKey();
+  GenericKey *high = processor_.InitKey();
+  latch_.RLock();
+  if (prefix.size() == key_schema_->GetColumnCount()) {
+    // a key without nulls serializes like its prefix padded with zero bytes
+    processor_.SerializePrefixToKey(low, prefix, KeyManager::KEY_FILL_LOW);
+    GetValue(low, result);
+    for (size_t i = 0; with_keys && i < result.size(); i++) {
+      keys.insert(keys.end(), reinterpret_cast<char *>(low), reinterpret_cast<char *>(low) + processor_.GetKeySize());
+    }
+  } else {
+    processor_.SerializeRangeToKeys(low, high, prefix, lower, lower_inclusive, upper, upper_inclusive);
+    Scan(
+        [&](const GenericKey *key) {
+          return processor_.CompareKeys(key, low) >= 0 && processor_.CompareKeys(key, high) < 0;
+        },
+        result, with_keys ? &keys : nullptr);
+  }
+  latch_.RUnlock();
+  free(low);
+  free(high);
+  return std::make_unique<ExtendibleHashCursor>(std::move(result), std::move(keys), processor_,
+                                                with_keys ? key_schema_ : nullptr);
+}
+
+dberr_t ExtendibleHashIndex::Destroy() {
+  latch_.WLock();
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    ExtendibleHashDirectory directory(buffer_pool_manager_, directory_page_id_);
+    for (uint32_t slot = 0; slot < directory.Size(); slot++) {
+      // a bucket is listed first at the slot equal to its low local depth bits
+      if (slot < (1U << directory.GetLocalDepth(slot))) {
+        FreeChain(directory.GetBucketPageId(slot));
+      }
+    }
+    directory.Destroy();
+    directory_page_id_ = INVALID_PAGE_ID;
+    Page *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+    header_page->WLatch();
+    reinterpret_cast<IndexRootsPage *>(header_page->GetData())->Delete(index_id_);
+    header_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  }
+  latch_.WUnlock();
+  return DB_SUCCESS;
+}
+
+uint32_t ExtendibleHashIndex::GetGlobalDepth() {
+  latch_.RLock();
+  uint32_t global_depth = 0;
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    global_depth = ExtendibleHashDirectory(buffer_pool_manager_, directory_page_id_).GetGlobalDepth();
+  }
+  latch_.RUnlock();
+  return global_depth;
+}
+
+bool ExtendibleHashIndex::Insert(const GenericKey *key, const RowId &value) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    page_id_t bucket_page_id;
+    Page *bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+    reinterpret_cast<HashBucketPage *>(bucket_page->GetData())->Init(bucket_page_id, processor_.GetKeySize());
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    Page *directory_page = buffer_pool_manager_->NewPage(directory_page_id_);
+    reinterpret_cast<HashDirectoryPage *>(directory_page->GetData())->Init(directory_page_id_, bucket_page_id);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    UpdateRootPageId(true);
+  }
+  uint64_t hash = processor_.HashKey(key);
+  ExtendibleHashDirectory directory(buffer_pool_manager_, directory_page_id_);
+  bool inserted = false;
+  while (true) {
+    uint32_t slot = directory.HashToSlot(hash);
+    // the key may be on any page of the chain, the pair goes to the first one with room
+    page_id_t head_page_id = directory.GetBucketPageId(slot);
+    page_id_t page_id = head_page_id;
+    page_id_t room_page_id = INVALID_PAGE_ID;
+    bool duplicate = false;
+    int chain_size = 0;
+    int hot_size = 0;
+    while (page_id != INVALID_PAGE_ID && !duplicate) {
+      auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      duplicate = bucket->Find(key, unique_ ? nullptr : &value, processor_) != -1;
+      chain_size += bucket->GetSize();
+      if (page_id == head_page_id) {
+        hot_size = bucket->GetHotSize();
+      }
+      if (room_page_id == INVALID_PAGE_ID && !bucket->IsFull()) {
+        room_page_id = page_id;
+      }
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    if (duplicate) {
+      break;
+    }
+    // a chain of keys mostly hashing alike is checked again only once it has doubled
+    if (room_page_id == INVALID_PAGE_ID && chain_size >= 2 * hot_size && CanSplit(directory, slot)) {
+      SplitBucket(directory, slot);
+      continue;
+    }
+    page_id = room_page_id != INVALID_PAGE_ID ? room_page_id : head_page_id;
+    AppendToChain(reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData()), key, value);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    inserted = true;
+    break;
+  }
+  return inserted;
+}
+
+bool ExtendibleHashIndex::Remove(const GenericKey *key, const RowId &value) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  ExtendibleHashDirectory directory(buffer_pool_manager_, directory_page_id_);
+  uint32_t slot = directory.HashToSlot(processor_.HashKey(key));
+  page_id_t head_page_id = directory.GetBucketPageId(slot);
+  HashBucketPage *prev = nullptr;
+  page_id_t page_id = head_page_id;
+  bool removed = false;
+  bool bucket_empty = false;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    int index = bucket->Find(key, &value, processor_);
+    if (index == -1) {
+      if (prev != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+      }
+      prev = bucket;
+      page_id = bucket->GetNextPageId();
+      continue;
+    }
+    bucket->RemoveAt(index);
+    removed = true;
+    // a chain has no empty page: an emptied overflow page is unlinked, an emptied head takes in the next page
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (bucket->GetSize() == 0 && prev != nullptr) {
+      prev->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else if (bucket->GetSize() == 0 && next_page_id != INVALID_PAGE_ID) {
+      auto *next = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+      bucket->MoveAllFrom(next);
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      buffer_pool_manager_->DeletePage(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    } else {
+      bucket_empty = bucket->GetSize() == 0;
+      if (prev != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+      }
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    prev = nullptr;
+    break;
+  }
+  if (prev != nullptr) {
+    buffer_pool_manager_->UnpinPage(prev->GetPageId(), false);
+  }
+  if (bucket_empty) {
+    MergeBucket(directory, slot);
+  }
+  return removed;
+}
+
+void ExtendibleHashIndex::GetValue(const GenericKey *key, std::vector<RowId> &result) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  ExtendibleHashDirectory directory(buffer_pool_manager_, directory_page_id_);
+  page_id_t page_id = directory.GetBucketPageId(directory.HashToSlot(processor_.HashKey(key)));
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    bucket->GetValue(key, processor_, result);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void ExtendibleHashIndex::Scan(const std::function<bool(const GenericKey *)> &match, std::vector<RowId> &result,
+                               std::vector<char> *keys) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  ExtendibleHashDirectory directory(buffer_pool_manager_, directory_page_id_);
+  for (uint32_t slot = 0; slot < directory.Size(); slot++) {
+    if (slot >= (1U << directory.GetLocalDepth(slot))) {
+      continue;  // listed at a lower slot already
+    }
+    page_id_t page_id = directory.GetBucketPageId(slot);
+    while (page_id != INVALID_PAGE_ID) {
+      auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      for (int i = 0; i < bucket->GetSize(); i++) {
+        if (match(bucket->KeyAt(i))) {
+          result.emplace_back(bucket->ValueAt(i));
+          if (keys != nullptr) {
+            const char *key = reinterpret_cast<const char *>(bucket->KeyAt(i));
+            keys->insert(keys->end(), key, key + processor_.GetKeySize());
+          }
+        }
+      }
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+}
+
+bool ExtendibleHashIndex::CanSplit(ExtendibleHashDirectory &directory, uint32_t slot) {
+  if (directory.GetLocalDepth(slot) == HASH_DIRECTORY_MAX_DEPTH) {
+    return false;
+  }
+  // the hashes of the whole chain, in the bits the directory can grow to
+  std::vector<uint64_t> hashes;
+  page_id_t page_id = directory.GetBucketPageId(slot);
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      hashes.push_back(processor_.HashKey(bucket->KeyAt(i)) & HASH_DIRECTORY_MAX_MASK);
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  // do not split while most keys hash alike (a hot key): each split would move only a few of the others away and
+  // grow the directory for nothing. Find the most common hash by majority vote, then count it.
+  uint64_t candidate = 0;
+  int votes = 0;
+  for (auto hash : hashes) {
+    if (votes == 0) {
+      candidate = hash;
+    }
+    votes += hash == candidate ? 1 : -1;
+  }
+  if (std::count(hashes.begin(), hashes.end(), candidate) * 2 <= static_cast<long>(hashes.size())) {
+    return true;
+  }
+  // Insert skips the check until the chain has doubled, so a hot key's chain is read again only log(n) times
+  page_id_t head_page_id = directory.GetBucketPageId(slot);
+  auto *head = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(head_page_id)->GetData());
+  head->SetHotSize(static_cast<int>(hashes.size()));
+  buffer_pool_manager_->UnpinPage(head_page_id, true);
+  return false;
+}
+
+void ExtendibleHashIndex::SplitBucket(ExtendibleHashDirectory &directory, uint32_t slot) {
+  uint32_t local_depth = directory.GetLocalDepth(slot);
+  if (local_depth == directory.GetGlobalDepth()) {
+    directory.IncrGlobalDepth();
+  }
+  // take the pairs out of the chain, the head page is reused for the half of hash bit `local_depth` 0
+  page_id_t page_id = directory.GetBucketPageId(slot);
+  auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  int key_size = processor_.GetKeySize();
+  std::vector<char> keys;
+  std::vector<RowId> values;
+  page_id_t next_page_id = bucket->GetNextPageId();
+  for (HashBucketPage *page = bucket; page != nullptr;) {
+    for (int i = 0; i < page->GetSize(); i++) {
+      const char *key = reinterpret_cast<const char *>(page->KeyAt(i));
+      keys.insert(keys.end(), key, key + key_size);
+      values.emplace_back(page->ValueAt(i));
+    }
+    if (page != bucket) {
+      page_id_t overflow_page_id = page->GetPageId();
+      next_page_id = page->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(overflow_page_id, false);
+      buffer_pool_manager_->DeletePage(overflow_page_id);
+    }
+    page = next_page_id == INVALID_PAGE_ID
+               ? nullptr
+               : reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+  }
+  bucket->Init(page_id, key_size);
+  page_id_t image_page_id;
+  auto *image = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->NewPage(image_page_id)->GetData());
+  image->Init(image_page_id, key_size);
+  uint32_t bit = 1U << local_depth;
+  for (uint32_t i = 0; i < directory.Size(); i++) {
+    if ((i & (bit - 1)) == (slot & (bit - 1))) {
+      directory.SetLocalDepth(i, local_depth + 1);
+      directory.SetBucketPageId(i, (i & bit) ? image_page_id : page_id);
+    }
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    auto *key = reinterpret_cast<const GenericKey *>(keys.data() + i * key_size);
+    AppendToChain((processor_.HashKey(key) & bit) ? image : bucket, key, values[i]);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+}
+
+void ExtendibleHashIndex::MergeBucket(ExtendibleHashDirectory &directory, uint32_t slot) {
+  while (directory.GetLocalDepth(slot) > 0) {
+    uint32_t local_depth = directory.GetLocalDepth(slot);
+    uint32_t image_slot = directory.GetSplitImageSlot(slot);
+    if (directory.GetLocalDepth(image_slot) != local_depth) {
+      break;
+    }
+    page_id_t page_id = directory.GetBucketPageId(slot);
+    page_id_t image_page_id = directory.GetBucketPageId(image_slot);
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    auto *image = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(image_page_id)->GetData());
+    // either side may be the empty one after an earlier merge, keep the other
+    bool empty = bucket->GetSize() == 0;
+    bool image_empty = image->GetSize() == 0;
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!empty && !image_empty) {
+      break;
+    }
+    page_id_t keep_page_id = empty ? image_page_id : page_id;
+    page_id_t drop_page_id = empty ? page_id : image_page_id;
+    uint32_t mask = (1U << (local_depth - 1)) - 1;
+    for (uint32_t i = 0; i < directory.Size(); i++) {
+      if ((i & mask) == (slot & mask)) {
+        directory.SetLocalDepth(i, local_depth - 1);
+        directory.SetBucketPageId(i, keep_page_id);
+      }
+    }
+    buffer_pool_manager_->DeletePage(drop_page_id);
+    slot &= mask;
+  }
+  while (directory.CanShrink()) {
+    directory.DecrGlobalDepth();
+  }
+}
+
+void ExtendibleHashIndex::AppendToChain(HashBucketPage *head, const GenericKey *key, const RowId &value) {
+  HashBucketPage *page = head;
+  while (page->IsFull()) {
+    page_id_t next_page_id = page->GetNextPageId();
+    HashBucketPage *next;
+    if (next_page_id == INVALID_PAGE_ID) {
+      next = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->NewPage(next_page_id)->GetData());
+      next->Init(next_page_id, processor_.GetKeySize());
+      page->SetNextPageId(next_page_id);
+    } else {
+      next = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+    }
+    if (page != head) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    }
+    page = next;
+  }
+  page->Insert(key, value);
+  if (page != head) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+}
+
+void ExtendibleHashIndex::FreeChain(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = reinterpret_cast<HashBucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+void ExtendibleHashIndex::UpdateRootPageId(bool insert_record) {
+  Page *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto *roots = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
+  header_page->WLatch();  // shared by all indexes
+  if (!insert_record || !roots->Insert(index_id_, directory_page_id_)) {
+    roots->Update(index_id_, directory_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+ExtendibleHashDirectory::ExtendibleHashDirectory(BufferPoolManager *buffer_pool_manager, page_id_t page_id)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  pages_.push_back(reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData()));
+  pages_.resize(std::max(1U, Size() / HashDirectoryPage::SLOTS_PER_PAGE), nullptr);
+  dirty_.resize(pages_.size(), false);
+}
+
+ExtendibleHashDirectory::~ExtendibleHashDirectory() {
+  for (size_t i = 0; i < pages_.size(); i++) {
+    if (pages_[i] != nullptr) {
+      buffer_pool_manager_->UnpinPage(pages_[i]->GetPageId(), dirty_[i]);
+    }
+  }
+}
+
+page_id_t ExtendibleHashDirectory::GetBucketPageId(uint32_t slot) {
+  return PageOf(slot)->GetBucketPageId(slot % HashDirectoryPage::SLOTS_PER_PAGE);
+}
+
+void ExtendibleHashDirectory::SetBucketPageId(uint32_t slot, page_id_t bucket_page_id) {
+  PageOf(slot, true)->SetBucketPageId(slot % HashDirectoryPage::SLOTS_PER_PAGE, bucket_page_id);
+}
+
+uint32_t ExtendibleHashDirectory::GetLocalDepth(uint32_t slot) {
+  return PageOf(slot)->GetLocalDepth(slot % HashDirectoryPage::SLOTS_PER_PAGE);
+}
+
+void ExtendibleHashDirectory::SetLocalDepth(uint32_t slot, uint32_t local_depth) {
+  PageOf(slot, true)->SetLocalDepth(slot % HashDirectoryPage::SLOTS_PER_PAGE, local_depth);
+}
+
+void ExtendibleHashDirectory::IncrGlobalDepth() {
+  ASSERT(GetGlobalDepth() < HASH_DIRECTORY_MAX_DEPTH, "Hash directory is at its max depth.");
+  uint32_t size = Size();
+  HashDirectoryPage *first = PageOf(0, true);
+  if (size < HashDirectoryPage::SLOTS_PER_PAGE) {
+    first->CopySlots(size, first, 0, size);
+  } else {
+    // the upper half goes to new pages, a copy of each page of the lower half
+    size_t page_count = pages_.size();
+    pages_.resize(page_count * 2, nullptr);
+    dirty_.resize(page_count * 2, true);
+    for (size_t i = 0; i < page_count; i++) {
+      page_id_t page_id;
+      auto *page = reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->NewPage(page_id)->GetData());
+      page->Init(page_id);
+      page->CopySlots(0, PageOf(i * HashDirectoryPage::SLOTS_PER_PAGE), 0, HashDirectoryPage::SLOTS_PER_PAGE);
+      first->SetDirectoryPageId(page_count + i, page_id);
+      pages_[page_count + i] = page;
+    }
+  }
+  first->SetGlobalDepth(GetGlobalDepth() + 1);
+}
+
+void ExtendibleHashDirectory::DecrGlobalDepth() {
+  ASSERT(CanShrink(), "Hash directory can not shrink.");
+  HashDirectoryPage *first = PageOf(0, true);
+  if (Size() > HashDirectoryPage::SLOTS_PER_PAGE) {
+    size_t page_count = pages_.size() / 2;
+    for (size_t i = page_count; i < pages_.size(); i++) {
+      page_id_t page_id = first->GetDirectoryPageId(i);
+      if (pages_[i] != nullptr) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+      }
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    pages_.resize(page_count);
+    dirty_.resize(page_count);
+  }
+  first->SetGlobalDepth(GetGlobalDepth() - 1);
+}
+
+bool ExtendibleHashDirectory::CanShrink() {
+  uint32_t global_depth = GetGlobalDepth();
+  if (global_depth == 0) {
+    return false;
+  }
+  for (uint32_t slot = 0; slot < Size(); slot++) {
+    if (GetLocalDepth(slot) == global_depth) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ExtendibleHashDirectory::Destroy() {
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pages_.size(); i++) {
+    page_ids.push_back(pages_[0]->GetDirectoryPageId(i));
+  }
+  for (size_t i = 0; i < pages_.size(); i++) {
+    if (pages_[i] != nullptr) {
+      buffer_pool_manager_->UnpinPage(page_ids[i], false);
+    }
+    buffer_pool_manager_->DeletePage(page_ids[i]);
+  }
+  pages_.clear();
+  dirty_.clear();
+}
+
+HashDirectoryPage *ExtendibleHashDirectory::PageOf(uint32_t slot, bool dirty) {
+  size_t index = slot / HashDirectoryPage::SLOTS_PER_PAGE;
+  if (pages_[index] == nullptr) {
+    page_id_t page_id = pages_[0]->GetDirectoryPageId(index);
+    pages_[index] = reinterpret_cast<HashDirectoryPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  }
+  dirty_[index] = dirty_[index] || dirty;
+  return pages_[index];
+}
@@ -1,14 +1,28 @@
 #include "index/index_iterator.h"
 
+#include <stdexcept>
+
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "page/b_plus_tree_posting_page.h"
+
+/** Follows the leaf chain for read-ahead, called on a pinned and read-latched page. */
+static page_id_t NextLeafPage(Page *page) {
+  return reinterpret_cast<BPlusTreeLeafPage *>(page->GetData())->GetNextPageId();
+}
 
 IndexIterator::IndexIterator() = default;
 
 IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
   page = reinterpret_cast<Page *>(buffer_pool_manager->FetchPage(current_page_id));
+  if (page == nullptr) {
+    current_page_id = INVALID_PAGE_ID;
+    throw std::runtime_error("out of memory");
+  }
   node = reinterpret_cast<LeafPage *>(page->GetData());
+  buffer_pool_manager->PrefetchPage(node->GetNextPageId(), DEFAULT_PREFETCH_DEPTH, NextLeafPage);
+  LoadPostings();
 }
 
 IndexIterator::~IndexIterator() {
@@ -17,24 +31,47 @@ IndexIterator::~IndexIterator() {
 }
 
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
+	if (!postings_.empty()) {
+		return std::make_pair(node->KeyAt(item_index), postings_[posting_index_]);
+	}
 	return node->GetItem(item_index);
 }
 
 IndexIterator &IndexIterator::operator++() {
+	if (++posting_index_ < postings_.size()) { // 同一个 key 的下一个 RowId
+		return *this;
+	}
+	posting_index_ = 0;
 	item_index++;
 	if (item_index == node->GetSize() && node->GetNextPageId() != INVALID_PAGE_ID) {
 		// 跳到下一个 node
 		Page *next_page = buffer_pool_manager->FetchPage(node->GetNextPageId());
+		if (next_page == nullptr) {
+			throw std::runtime_error("out of memory");
+		}
 		buffer_pool_manager->UnpinPage(page->GetPageId(), false);
 		page = next_page;
+		current_page_id = page->GetPageId();
 		node = reinterpret_cast<LeafPage *>(page->GetData());
 		item_index = 0;
+		// stay a few leaves ahead so the next boundary does not block on a read
+		buffer_pool_manager->PrefetchPage(node->GetNextPageId(), DEFAULT_PREFETCH_DEPTH, NextLeafPage);
 	}
+	LoadPostings();
 	return *this;
 }
 
+void IndexIterator::LoadPostings() {
+	postings_.clear();
+	if (node->GetValueSize() == sizeof(RowId) || item_index >= node->GetSize()) {
+		return;
+	}
+	PostingPage::CollectRowIds(node->ValuesAt(item_index), node->GetValueSize() / sizeof(RowId), buffer_pool_manager,
+	                           postings_);
+}
+
 bool IndexIterator::operator==(const IndexIterator &itr) const {
-  return current_page_id == itr.current_page_id && item_index == itr.item_index;
+  return current_page_id == itr.current_page_id && item_index == itr.item_index && posting_index_ == itr.posting_index_;
 }
 
 bool IndexIterator::operator!=(const IndexIterator &itr) const {
@@ -0,0 +1,152 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+KeySorter::KeySorter(const KeyManager &KM, size_t memory_budget)
+    : processor_(KM), entry_size_(KM.GetKeySize() + sizeof(RowId)) {
+  buffer_capacity_ = std::max<size_t>(1, memory_budget / entry_size_);
+  buffer_.reset(new char[buffer_capacity_ * entry_size_]);
+}
+
+KeySorter::~KeySorter() {
+  for (auto &run : runs_) {
+    fclose(run.file_);
+  }
+}
+
+void KeySorter::Add(const GenericKey *key, const RowId &rid) {
+  ASSERT(!finished_, "Entry added after the sorter was finished.");
+  if (buffer_entries_ == buffer_capacity_) {
+    SortBuffer();
+    SpillRun();
+  }
+  char *entry = EntryAt(buffer_.get(), buffer_entries_++);
+  memcpy(entry, key, processor_.GetKeySize());
+  memcpy(entry + processor_.GetKeySize(), &rid, sizeof(RowId));
+  count_++;
+}
+
+void KeySorter::Finish() {
+  ASSERT(!finished_, "Sorter finished twice.");
+  finished_ = true;
+  SortBuffer();
+  if (runs_.empty()) {
+    return;
+  }
+  if (buffer_entries_ > 0) {
+    SpillRun();
+  }
+  // the merge buffers take the memory of the sort buffer, split evenly over the runs
+  size_t budget = buffer_capacity_ * entry_size_;
+  buffer_.reset();
+  order_.clear();
+  order_.shrink_to_fit();
+  block_entries_ = std::max<size_t>(PAGE_SIZE / entry_size_ + 1, budget / entry_size_ / runs_.size());
+  for (auto &run : runs_) {
+    run.block_.reset(new char[block_entries_ * entry_size_]);
+  }
+  Rewind();
+}
+
+size_t KeySorter::CountKeys() {
+  ASSERT(finished_ && next_ == 0, "Keys counted before the sorter was finished or after it was read.");
+  std::unique_ptr<char[]> last_key(new char[processor_.GetKeySize()]);
+  size_t keys = 0;
+  GenericKey *key = nullptr;
+  RowId rid;
+  while (Next(key, rid)) {
+    if (keys == 0 || processor_.CompareKeys(key, reinterpret_cast<GenericKey *>(last_key.get())) != 0) {
+      memcpy(last_key.get(), key, processor_.GetKeySize());
+      keys++;
+    }
+  }
+  Rewind();
+  return keys;
+}
+
+void KeySorter::Rewind() {
+  next_ = 0;
+  merge_heap_.clear();
+  for (size_t i = 0; i < runs_.size(); i++) {
+    rewind(runs_[i].file_);
+    if (FillBlock(runs_[i])) {
+      merge_heap_.push_back(i);
+    }
+  }
+  std::make_heap(merge_heap_.begin(), merge_heap_.end(), [this](size_t l, size_t r) { return RunGreater(l, r); });
+}
+
+bool KeySorter::Next(GenericKey *&key, RowId &rid) {
+  ASSERT(finished_, "Sorter read before it was finished.");
+  char *entry = nullptr;
+  if (runs_.empty()) {
+    if (next_ == buffer_entries_) {
+      return false;
+    }
+    entry = EntryAt(buffer_.get(), order_[next_++]);
+  } else {
+    auto greater = [this](size_t l, size_t r) { return RunGreater(l, r); };
+    if (merge_heap_.empty()) {
+      return false;
+    }
+    // the entry returned by the previous call is still at the top, step its run past it first
+    if (next_++ > 0) {
+      Run &top = runs_[merge_heap_.front()];
+      std::pop_heap(merge_heap_.begin(), merge_heap_.end(), greater);
+      if (++top.pos_ < top.block_entries_ || FillBlock(top)) {
+        std::push_heap(merge_heap_.begin(), merge_heap_.end(), greater);
+      } else {
+        merge_heap_.pop_back();
+        if (merge_heap_.empty()) {
+          return false;
+        }
+      }
+    }
+    Run &run = runs_[merge_heap_.front()];
+    entry = EntryAt(run.block_.get(), run.pos_);
+  }
+  key = reinterpret_cast<GenericKey *>(entry);
+  memcpy(&rid, entry + processor_.GetKeySize(), sizeof(RowId));
+  return true;
+}
+
+void KeySorter::SortBuffer() {
+  order_.resize(buffer_entries_);
+  std::iota(order_.begin(), order_.end(), 0);
+  char *base = buffer_.get();
+  std::sort(order_.begin(), order_.end(), [this, base](uint32_t l, uint32_t r) {
+    return processor_.CompareKeys(reinterpret_cast<GenericKey *>(EntryAt(base, l)),
+                                  reinterpret_cast<GenericKey *>(EntryAt(base, r))) < 0;
+  });
+}
+
+void KeySorter::SpillRun() {
+  FILE *file = std::tmpfile();
+  if (file == nullptr) {
+    throw std::runtime_error("failed to create a temporary file for an index build");
+  }
+  for (auto index : order_) {
+    if (fwrite(EntryAt(buffer_.get(), index), entry_size_, 1, file) != 1) {
+      fclose(file);
+      throw std::runtime_error("failed to write a sorted run of an index build");
+    }
+  }
+  rewind(file);
+  runs_.emplace_back();
+  runs_.back().file_ = file;
+  buffer_entries_ = 0;
+}
+
+bool KeySorter::FillBlock(Run &run) {
+  run.block_entries_ = fread(run.block_.get(), entry_size_, block_entries_, run.file_);
+  run.pos_ = 0;
+  return run.block_entries_ > 0;
+}
+
+bool KeySorter::RunGreater(size_t lhs, size_t rhs) {
+  int cmp = processor_.CompareKeys(reinterpret_cast<GenericKey *>(EntryAt(runs_[lhs].block_.get(), runs_[lhs].pos_)),
+                                   reinterpret_cast<GenericKey *>(EntryAt(runs_[rhs].block_.get(), runs_[rhs].pos_)));
+  return cmp > 0 || (cmp == 0 && lhs > rhs);
+}
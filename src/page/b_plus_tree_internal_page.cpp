@@ -2,7 +2,7 @@
 
 #include "index/generic_key.h"
 
-#define pairs_off (data_ + INTERNAL_PAGE_HEADER_SIZE)
+#define pairs_off (data_)
 #define pair_size (GetKeySize() + sizeof(page_id_t))
 #define key_off 0
 #define val_off GetKeySize()
@@ -91,24 +91,17 @@ void BPlusTreeInternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * 用了二分查找
  */
 page_id_t BPlusTreeInternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
-
 	int left = 1; // Start the search from the second key
-	int right = GetSize() - 1;
-	while (left < right) {
+	int right = GetSize();
+	while (left < right) { // 找到第一个 kvp[index].key > key
 		int mid = left + (right - left) / 2;
-		const GenericKey *key_at_mid = KeyAt(mid);
-		int flag = KM.CompareKeys(key, key_at_mid);
-		if (flag == -1) { // l < r
-			right = mid - 1;
-		} else if (flag == 1) { // l > r
+		if (KM.CompareKeys(KeyAt(mid), key) <= 0) { // kvp[mid].key <= key
 			left = mid + 1;
-		} else { // flag == 0; equal
-			return ValueAt(mid); // kvp[index].key == key
-			//index = mid;
-			//break;
+		} else {
+			right = mid;
 		}
 	}
-	return ValueAt(left); //return INVALID_PAGE_ID;
+	return ValueAt(left - 1); // kvp[left - 1].key <= key < kvp[left].key
 }
 
 /*****************************************************************************
@@ -265,6 +258,7 @@ void BPlusTreeInternalPage::MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
                                      BufferPoolManager *buffer_pool_manager) {
 	recipient->SetKeyAt(0, middle_key);
 	recipient->CopyFirstFrom(ValueAt(GetSize() - 1), buffer_pool_manager);
+	recipient->SetKeyAt(0, KeyAt(GetSize() - 1)); // 移过去的 key 成为父节点中新的分隔 key
 	IncreaseSize(-1);
 }
 
@@ -9,8 +9,8 @@
  * kvp[index].key
  * kvp[index].value
 */
-#define pairs_off (data_ + LEAF_PAGE_HEADER_SIZE)
-#define pair_size (GetKeySize() + sizeof(RowId))
+#define pairs_off (data_)
+#define pair_size (GetKeySize() + GetValueSize())
 #define key_off 0
 #define val_off GetKeySize()
 /*****************************************************************************
@@ -26,7 +26,7 @@
  * next page id and set max size
  * 未初始化next_page_id
  */
-void BPlusTreeLeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
+void BPlusTreeLeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size, int value_size) {
 	SetPageType(IndexPageType::LEAF_PAGE);	// PageType (4)
 	SetSize(0);								// CurrentSize (4)
 	SetPageId(page_id);						// PageId(4)
@@ -34,6 +34,7 @@ void BPlusTreeLeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_siz
 	SetNextPageId(INVALID_PAGE_ID);			// NextPageId (4) LeafPage 新增的域
 	SetMaxSize(max_size);					// MaxSize (4)
 	SetKeySize(key_size);
+	value_size_ = value_size;				// ValueSize (4) 非唯一索引的 value 是一组 RowId
 }
 
 /**
@@ -50,6 +51,10 @@ void BPlusTreeLeafPage::SetNextPageId(page_id_t next_page_id) {
   }
 }
 
+int BPlusTreeLeafPage::GetValueSize() const {
+  return value_size_;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -59,25 +64,17 @@ void BPlusTreeLeafPage::SetNextPageId(page_id_t next_page_id) {
  * 二分查找
  */
 int BPlusTreeLeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-	//int index = -1; // -1: not found
 	int left = 0;
-	int right = GetSize() - 1;
+	int right = GetSize(); // 可能返回 GetSize()，即所有 key 都比它小
 	while (left < right) {
 		int mid = left + (right - left) / 2;
-		const GenericKey *key_at_mid = KeyAt(mid);
-		int flag = KM.CompareKeys(key, key_at_mid);
-		if (flag == -1) { // l < r
-			right = mid - 1;
-		} else if (flag == 1) { // l > r
+		if (KM.CompareKeys(KeyAt(mid), key) < 0) { // kvp[mid].key < key
 			left = mid + 1;
-		} else { // flag == 0; equal
-			return mid; // kvp[index].key == key
-			//index = mid;
-			//break;
+		} else {
+			right = mid;
 		}
 	}
-	return left; // kvp[index].key > key
-	//return index;
+	return left; // kvp[index].key >= key
 }
 
 /*
@@ -106,7 +103,16 @@ RowId BPlusTreeLeafPage::ValueAt(int index) const {
  * Helper method to set the `value` to kvp[index].value
 */
 void BPlusTreeLeafPage::SetValueAt(int index, RowId value) {
-  *reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off) = value;
+  RowId *values = ValuesAt(index);
+  values[0] = value;
+  std::fill(values + 1, values + GetValueSize() / sizeof(RowId), INVALID_ROWID);
+}
+
+/**
+ * Helper method to find and return the row ids of kvp[index].value
+*/
+RowId *BPlusTreeLeafPage::ValuesAt(int index) {
+  return reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off);
 }
 
 /**
@@ -120,7 +126,7 @@ void *BPlusTreeLeafPage::PairPtrAt(int index) {
  * Helper method to copy all pair_num's pair from src to dest
 */
 void BPlusTreeLeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+  memcpy(dest, src, pair_num * pair_size);
 }
 
 /*
@@ -142,7 +148,7 @@ std::pair<GenericKey *, RowId> BPlusTreeLeafPage::GetItem(int index) {
  */
 int BPlusTreeLeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
 	int index = KeyIndex(key, KM); // key <= kvp[index].key
-	if (key == KeyAt(index)) { // key == kvp[index].key, no insert
+	if (index < GetSize() && KM.CompareKeys(key, KeyAt(index)) == 0) { // key == kvp[index].key, no insert
 		return GetSize();
 	} else { // key < kvp[index].key
 		// TODO: 一次性 copy
@@ -190,7 +196,7 @@ void BPlusTreeLeafPage::CopyNFrom(void *src, int size) {
 bool BPlusTreeLeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
 	bool flag = false;
 	int index = KeyIndex(key, KM); // kvp[index].key >= key; 取 = 的情况
-	if (KM.CompareKeys(key, KeyAt(index)) == 0) {
+	if (index < GetSize() && KM.CompareKeys(key, KeyAt(index)) == 0) {
 		value = ValueAt(index);
 		flag = true;
 	}
@@ -210,7 +216,7 @@ bool BPlusTreeLeafPage::Lookup(const GenericKey *key, RowId &value, const KeyMan
 int BPlusTreeLeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
 	int page_size = -1;
 	int index = KeyIndex(key, KM);
-	if (KM.CompareKeys(key, KeyAt(index)) != 0) {
+	if (index >= GetSize() || KM.CompareKeys(key, KeyAt(index)) != 0) {
 		page_size = GetSize();
 	} else {
 		for (int i = index + 1; i < GetSize(); i++) {
@@ -261,17 +267,15 @@ void BPlusTreeLeafPage::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 void BPlusTreeLeafPage::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
 	int index = 0;
-	recipient->CopyLastFrom(KeyAt(index), ValueAt(index));
+	recipient->CopyLastFrom(PairPtrAt(index));
 	RemoveByIndex(index);
 }
 
 /*
  * Copy the item into the end of my item list. (Append item to my array)
  */
-void BPlusTreeLeafPage::CopyLastFrom(GenericKey *key, const RowId value) {
-	int index = GetSize();
-	SetKeyAt(index, key);
-	SetValueAt(index, value);
+void BPlusTreeLeafPage::CopyLastFrom(void *pair) {
+	PairCopy(PairPtrAt(GetSize()), pair, 1); // 整个 pair 一起搬，value 可能是一组 RowId
 	IncreaseSize(1);
 }
 
@@ -280,7 +284,7 @@ void BPlusTreeLeafPage::CopyLastFrom(GenericKey *key, const RowId value) {
  */
 void BPlusTreeLeafPage::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
 	int index = GetSize() - 1;
-	recipient->CopyFirstFrom(KeyAt(index), ValueAt(index));
+	recipient->CopyFirstFrom(PairPtrAt(index));
 	RemoveByIndex(index);
 }
 
@@ -288,12 +292,10 @@ void BPlusTreeLeafPage::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
  * Insert item at the front of my items. Move items accordingly.
  *
  */
-void BPlusTreeLeafPage::CopyFirstFrom(GenericKey *key, const RowId value) {
-	int index = 0;
+void BPlusTreeLeafPage::CopyFirstFrom(void *pair) {
 	for (int i = GetSize(); i > 0; i--) {
 		PairCopy(PairPtrAt(i), PairPtrAt(i-1), 1);
 	}
-	SetKeyAt(index, key);
-	SetValueAt(index, value);
+	PairCopy(PairPtrAt(0), pair, 1);
 	IncreaseSize(1);
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "page/b_plus_tree_posting_page.h"
+
+#include <algorithm>
+
+void BPlusTreePostingPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+}
+
+int BPlusTreePostingPage::RowIdIndex(const RowId &rid) const {
+  return static_cast<int>(std::lower_bound(rids_, rids_ + size_, rid) - rids_);
+}
+
+bool BPlusTreePostingPage::Insert(const RowId &rid) {
+  ASSERT(!IsFull(), "Insert into a full posting page.");
+  int index = RowIdIndex(rid);
+  if (index < size_ && rids_[index] == rid) {
+    return false;
+  }
+  std::copy_backward(rids_ + index, rids_ + size_, rids_ + size_ + 1);
+  rids_[index] = rid;
+  size_++;
+  return true;
+}
+
+bool BPlusTreePostingPage::Remove(const RowId &rid) {
+  int index = RowIdIndex(rid);
+  if (index == size_ || !(rids_[index] == rid)) {
+    return false;
+  }
+  std::copy(rids_ + index + 1, rids_ + size_, rids_ + index);
+  size_--;
+  return true;
+}
+
+void BPlusTreePostingPage::Append(const RowId *rids, int count) {
+  ASSERT(size_ + count <= MAX_SIZE, "Posting page overflow.");
+  std::copy(rids, rids + count, rids_ + size_);
+  size_ += count;
+}
+
+void BPlusTreePostingPage::MoveHalfTo(BPlusTreePostingPage *recipient) {
+  int half = size_ / 2;
+  recipient->Append(rids_ + size_ - half, half);
+  size_ -= half;
+}
+
+int BPlusTreePostingPage::RowIdCount(const RowId *value, int slots) {
+  if (IsPostingList(value)) {
+    return static_cast<int>(value[1].GetSlotNum());
+  }
+  int count = 0;
+  while (count < slots && value[count].GetPageId() != INVALID_PAGE_ID) {
+    count++;
+  }
+  return count;
+}
+
+void BPlusTreePostingPage::CollectRowIds(const RowId *value, int slots, BufferPoolManager *bpm,
+                                         std::vector<RowId> &result) {
+  if (!IsPostingList(value)) {
+    result.insert(result.end(), value, value + RowIdCount(value, slots));
+    return;
+  }
+  result.reserve(result.size() + value[1].GetSlotNum());
+  page_id_t page_id = value[0].GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = bpm->FetchPage(page_id);
+    auto *node = reinterpret_cast<PostingPage *>(page->GetData());
+    result.insert(result.end(), node->rids_, node->rids_ + node->size_);
+    page_id = node->next_page_id_;
+    bpm->UnpinPage(page->GetPageId(), false);
+  }
+}
@@ -1,5 +1,7 @@
 #include "page/bitmap_page.h"
 
+#include <cstring>
+
 #include "glog/logging.h"
 
 /**
@@ -8,29 +10,31 @@
  */
 template <size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
-	bool flag = false;
-	if (page_allocated_ < GetMaxSupportedSize() && next_free_page_ < GetMaxSupportedSize()) { // 还有空闲页
-		page_offset = next_free_page_; // 该空闲页的下标，注意传的是地址
-		uint32_t page_byte_index = next_free_page_ / 8; // 该空闲页的下标 / 8 = 该空闲页在 bytes 中的下标
-		uint8_t page_bit_index = next_free_page_ % 8;
-		// page_offset = page_byte_index * 8 + page_bit_index; 7,6,5,4,3,2,1,0; 小端?
-		bytes[page_byte_index] = bytes[page_byte_index] | (0x01 << page_bit_index); // 将对应的bit置一
-		page_allocated_++; // 并对总数加一
-		// 更新 next_free_page_
-		for (uint32_t i = next_free_page_; i < GetMaxSupportedSize(); i++) { // uint32_t i=next_free_page_ 亦可
-		// DiskManagerTest.FreePageAllocationTest (8989 ms) i = 0
-		// DiskManagerTest.FreePageAllocationTest (280 ms)  i = next_free_page_ 
-			if (IsPageFree(i)) {
-				next_free_page_ = i; // 找到第一个 free 的 page
-				break;
-			}
-		}
-		flag = true;
-	} else {
-		flag = false;
+	if (page_allocated_ >= GetMaxSupportedSize()) {
+		return false;
 	}
+	// next_free_page_ is a lower bound of the first free page, scan from there and wrap around once
+	uint32_t start = next_free_page_ < GetMaxSupportedSize() ? next_free_page_ : 0;
+	if (!FindFreePage(start, GetMaxSupportedSize(), page_offset) && !FindFreePage(0, start, page_offset)) {
+		return false;
+	}
+	bytes[page_offset / 8] |= (0x01 << (page_offset % 8));
+	page_allocated_++;
+	next_free_page_ = page_offset + 1;
+	return true;
+}
 
-	return flag;
+template <size_t PageSize>
+bool BitmapPage<PageSize>::AllocatePageAt(uint32_t page_offset) {
+	if (page_offset >= GetMaxSupportedSize() || !IsPageFree(page_offset)) {
+		return false;
+	}
+	bytes[page_offset / 8] |= (0x01 << (page_offset % 8));
+	page_allocated_++;
+	if (page_offset == next_free_page_) {
+		next_free_page_ = page_offset + 1;
+	}
+	return true;
 }
 
 /**
@@ -38,23 +42,39 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
  */
 template <size_t PageSize>
 bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) { 
-	bool flag = false;
-	if (page_offset < GetMaxSupportedSize()) { // 首先要在范围内
-		if (!IsPageFree(page_offset)) { // 其次该页需要已经被分配
-			// 尝试 DeAllocate Page
-			uint32_t byte_index = page_offset / 8;
-			uint8_t bit_index = page_offset % 8;
-			bytes[byte_index] = bytes[byte_index] & (~(0x01 << bit_index));
-			page_allocated_--;
-			next_free_page_ = page_offset;
-			flag = true;
-		} else {
-			flag = false;
+	// 首先要在范围内, 其次该页需要已经被分配
+	if (page_offset >= GetMaxSupportedSize() || IsPageFree(page_offset)) {
+		return false;
+	}
+	bytes[page_offset / 8] &= ~(0x01 << (page_offset % 8));
+	page_allocated_--;
+	if (page_offset < next_free_page_) {
+		next_free_page_ = page_offset;
+	}
+	return true;
+}
+
+template <size_t PageSize>
+bool BitmapPage<PageSize>::FindFreePage(uint32_t from, uint32_t to, uint32_t &page_offset) const {
+	// bit i of the bitmap is bit i % 64 of little endian word i / 64, so a whole word of pages is checked at once
+	for (uint32_t word_index = from / 64; word_index * 64 < to; word_index++) {
+		uint64_t word;
+		memcpy(&word, bytes + word_index * 8, sizeof(word));
+		word = ~word;
+		if (word_index == from / 64) {
+			word &= ~0ULL << (from % 64);
 		}
-	} else {
-		flag = false;
+		if (word == 0) {
+			continue;
+		}
+		uint32_t offset = word_index * 64 + __builtin_ctzll(word);
+		if (offset >= to) {
+			return false;
+		}
+		page_offset = offset;
+		return true;
 	}
-	return flag;
+	return false;
 }
 
 /**
@@ -0,0 +1,56 @@
+#include "page/extendible_hash_bucket_page.h"
+
+void ExtendibleHashBucketPage::Init(page_id_t page_id, int key_size) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+  key_size_ = key_size;
+  hot_size_ = 0;
+}
+
+RowId ExtendibleHashBucketPage::ValueAt(int index) const {
+  RowId value;
+  memcpy(&value, PairPtrAt(index) + key_size_, sizeof(RowId));
+  return value;
+}
+
+int ExtendibleHashBucketPage::Find(const GenericKey *key, const RowId *value, const KeyManager &KM) {
+  for (int i = 0; i < size_; i++) {
+    if (KM.CompareKeys(KeyAt(i), key) == 0 && (value == nullptr || ValueAt(i) == *value)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void ExtendibleHashBucketPage::GetValue(const GenericKey *key, const KeyManager &KM, std::vector<RowId> &result) {
+  for (int i = 0; i < size_; i++) {
+    if (KM.CompareKeys(KeyAt(i), key) == 0) {
+      result.emplace_back(ValueAt(i));
+    }
+  }
+}
+
+void ExtendibleHashBucketPage::Insert(const GenericKey *key, const RowId &value) {
+  ASSERT(!IsFull(), "Insert into a full hash bucket.");
+  char *pair = PairPtrAt(size_);
+  memcpy(pair, key, key_size_);
+  memcpy(pair + key_size_, &value, sizeof(RowId));
+  size_++;
+}
+
+void ExtendibleHashBucketPage::RemoveAt(int index) {
+  ASSERT(index < size_, "Remove out of the hash bucket.");
+  size_--;
+  if (index != size_) {
+    memcpy(PairPtrAt(index), PairPtrAt(size_), key_size_ + sizeof(RowId));
+  }
+}
+
+void ExtendibleHashBucketPage::MoveAllFrom(ExtendibleHashBucketPage *next) {
+  ASSERT(size_ == 0 && next->key_size_ == key_size_, "Move into a non-empty hash bucket.");
+  memcpy(pairs_, next->pairs_, next->size_ * (key_size_ + sizeof(RowId)));
+  size_ = next->size_;
+  next_page_id_ = next->next_page_id_;
+  next->size_ = 0;
+}
@@ -0,0 +1,23 @@
+#include "page/extendible_hash_directory_page.h"
+
+#include <algorithm>
+
+void ExtendibleHashDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+  Init(page_id);
+  global_depth_ = 0;
+  local_depths_[0] = 0;
+  bucket_page_ids_[0] = bucket_page_id;
+  directory_page_ids_[0] = page_id;
+}
+
+void ExtendibleHashDirectoryPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  global_depth_ = 0;
+}
+
+void ExtendibleHashDirectoryPage::CopySlots(uint32_t to_slot, const ExtendibleHashDirectoryPage *from,
+                                            uint32_t from_slot, uint32_t count) {
+  std::copy(from->local_depths_ + from_slot, from->local_depths_ + from_slot + count, local_depths_ + to_slot);
+  std::copy(from->bucket_page_ids_ + from_slot, from->bucket_page_ids_ + from_slot + count,
+            bucket_page_ids_ + to_slot);
+}
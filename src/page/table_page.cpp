@@ -43,6 +43,21 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn, LockMana
   return true;
 }
 
+bool TablePage::AppendTuple(Row &row, uint32_t serialized_size, Schema *schema) {
+  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+    return false;
+  }
+  uint32_t slot = GetTupleCount();
+  SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
+  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
+  ASSERT(write_bytes == serialized_size, "Unexpected behavior in row serialize.");
+  SetTupleOffsetAtSlot(slot, GetFreeSpacePointer());
+  SetTupleSize(slot, serialized_size);
+  row.SetRowId(RowId(GetTablePageId(), slot));
+  SetTupleCount(slot + 1);
+  return true;
+}
+
 bool TablePage::MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort.
@@ -126,8 +141,8 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
   SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // the slot stays in the slot array and is reused by InsertTuple, the tuple count covers every slot
   SetTupleSize(slot_num, 0);
-  SetTupleCount(GetTupleCount() - 1);
   SetTupleOffsetAtSlot(slot_num, 0);
 
   // Update all tuple offsets.
@@ -163,6 +163,10 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeCreateIndex";
     case kNodeDropIndex:
       return "kNodeDropIndex";
+    case kNodeIndexType:
+      return "kNodeIndexType";
+    case kNodeIndexInclude:
+      return "kNodeIndexInclude";
     case kNodeTrxBegin:
       return "kNodeTrxBegin";
     case kNodeTrxCommit:
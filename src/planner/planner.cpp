@@ -36,24 +36,236 @@ void Planner::PlanQuery(pSyntaxNode ast) {
 }
 AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> statement) {
   auto out_schema = MakeOutputSchema(statement->column_list_);
+  return PlanScan(statement->table_name_, out_schema, statement->where_, false);
+}
+
+AbstractPlanNodeRef Planner::PlanScan(const std::string &table_name, const Schema *out_schema,
+                                      const AbstractExpressionRef &where, bool modifies) {
   vector<IndexInfo *> indexes;
-  vector<IndexInfo *> available_index;
-  context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
+  context_->GetCatalog()->GetTableIndexes(table_name, indexes);
+  return PlanScan(table_name, indexes, out_schema, where, modifies);
+}
+
+AbstractPlanNodeRef Planner::PlanScan(const std::string &table_name, const std::vector<IndexInfo *> &indexes,
+                                      const Schema *out_schema, const AbstractExpressionRef &where, bool modifies) {
+  std::vector<AbstractExpressionRef> conjuncts;
+  if (where != nullptr) {
+    SplitLogic(where, LogicType::And, conjuncts);
+  }
+  // pick the index answering most of the WHERE clause: the longest equality prefix, then a range after it, and among
+  // those one storing every column the query reads, which then never reads the table
+  IndexInfo *best_index = nullptr;
+  IndexKeyRange best_range;
+  std::vector<bool> best_used;
+  AbstractExpressionRef best_residual = nullptr;
+  bool best_covered = false;
+  size_t best_score = 0;
   for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
+    std::vector<bool> used(conjuncts.size(), false);
+    IndexKeyRange range = MatchIndex(index, conjuncts, used);
+    size_t score = range.prefix_.size() * 2 + (range.lower_ != nullptr || range.upper_ != nullptr ? 1 : 0);
+    // the executor only checks what the key range does not answer
+    AbstractExpressionRef residual = nullptr;
+    for (size_t i = 0; i < conjuncts.size(); i++) {
+      if (used[i]) {
+        continue;
+      }
+      residual = residual == nullptr ? conjuncts[i]
+                                     : std::make_shared<LogicExpression>(residual, conjuncts[i], LogicType::And);
+    }
+    bool covered = !modifies && Covers(index, out_schema, residual);
+    score = score * 2 + (covered ? 1 : 0);
+    // on a tie, a whole key looked up by equality reads a directory page and a bucket in a hash index, fewer pages than
+    // a descent of a B+ tree
+    bool hash_lookup = index->GetIndexType() == "hash" && !range.prefix_.empty();
+    score = score * 2 + (hash_lookup ? 1 : 0);
+    if (score > best_score) {
+      best_index = index;
+      best_range = range;
+      best_used = used;
+      best_residual = residual;
+      best_covered = covered;
+      best_score = score;
+    }
+  }
+  // a key range fetching rows from the table reads them in key order, jumping between pages; unless it is a lookup of
+  // a whole key, collect the row ids of all the indexes that help, ANDed and ORed like the WHERE clause, and read each
+  // page once. A scan feeding an UPDATE or DELETE always collects the row ids first: a cursor still open on an index
+  // the statement changes could meet the rows it changed again
+  if (best_index == nullptr || modifies ||
+      (!best_covered && best_range.prefix_.size() < best_index->GetIndex()->GetKeyColumnCount())) {
+    std::vector<bool> used(conjuncts.size(), false);
+    auto condition = MatchBitmap(indexes, conjuncts, used);
+    if (condition == nullptr) {
+      return make_shared<SeqScanPlanNode>(out_schema, table_name, where);
+    }
+    AbstractExpressionRef residual = nullptr;
+    for (size_t i = 0; i < conjuncts.size(); i++) {
+      if (!used[i]) {
+        residual = residual == nullptr ? conjuncts[i]
+                                       : std::make_shared<LogicExpression>(residual, conjuncts[i], LogicType::And);
+      }
+    }
+    return make_shared<BitmapHeapScanPlanNode>(out_schema, table_name, condition, residual);
+  }
+  return make_shared<IndexScanPlanNode>(out_schema, table_name, vector<IndexInfo *>{best_index},
+                                        vector<IndexKeyRange>{best_range}, best_residual != nullptr, best_residual,
+                                        best_covered);
+}
+
+bool Planner::Covers(IndexInfo *index, const Schema *out_schema, const AbstractExpressionRef &predicate) {
+  std::vector<uint32_t> columns;
+  for (auto column : out_schema->GetColumns()) {
+    columns.push_back(column->GetTableInd());
+  }
+  std::vector<AbstractExpressionRef> exprs;
+  if (predicate != nullptr) {
+    exprs.push_back(predicate);
+  }
+  while (!exprs.empty()) {
+    auto expr = exprs.back();
+    exprs.pop_back();
+    if (expr->GetType() == ExpressionType::ColumnExpression) {
+      columns.push_back(dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx());
+    }
+    exprs.insert(exprs.end(), expr->GetChildren().begin(), expr->GetChildren().end());
+  }
+  auto &stored = index->GetIndexKeySchema()->GetColumns();
+  return std::all_of(columns.begin(), columns.end(), [&stored](uint32_t col_id) {
+    return std::any_of(stored.begin(), stored.end(),
+                       [col_id](Column *column) { return column->GetTableInd() == col_id; });
+  });
+}
+
+void Planner::SplitLogic(const AbstractExpressionRef &predicate, LogicType logic_type,
+                         std::vector<AbstractExpressionRef> &terms) {
+  if (predicate->GetType() != ExpressionType::LogicExpression ||
+      dynamic_pointer_cast<LogicExpression>(predicate)->logic_type_ != logic_type) {
+    terms.push_back(predicate);
+    return;
+  }
+  SplitLogic(predicate->GetChildAt(0), logic_type, terms);
+  SplitLogic(predicate->GetChildAt(1), logic_type, terms);
+}
+
+BitmapIndexConditionRef Planner::MatchBitmap(const std::vector<IndexInfo *> &indexes,
+                                             const std::vector<AbstractExpressionRef> &conjuncts,
+                                             std::vector<bool> &used) {
+  std::vector<BitmapIndexConditionRef> children;
+  // the best key range first, then further indexes only where equalities give their whole key: those return a few
+  // row ids, cheap to collect and intersect, while a key prefix or a range could return much of the table just to
+  // intersect with rows the first one already narrowed down
+  while (true) {
+    BitmapIndexCondition best;
+    std::vector<bool> best_used;
+    size_t best_score = 0;
+    for (auto index : indexes) {
+      std::vector<bool> index_used = used;
+      IndexKeyRange range = MatchIndex(index, conjuncts, index_used);
+      size_t score = range.prefix_.size() * 2 + (range.lower_ != nullptr || range.upper_ != nullptr ? 1 : 0);
+      if (score > best_score &&
+          (children.empty() || range.prefix_.size() == index->GetIndex()->GetKeyColumnCount())) {
+        best.index_ = index;
+        best.key_range_ = range;
+        best_used = std::move(index_used);
+        best_score = score;
+      }
+    }
+    if (best.index_ == nullptr) {
+      break;
+    }
+    children.push_back(std::make_shared<BitmapIndexCondition>(std::move(best)));
+    used = std::move(best_used);
+  }
+  // an OR is answered by the union of its terms if every one of them is answered by some index
+  for (size_t i = 0; i < conjuncts.size(); i++) {
+    if (used[i] || conjuncts[i]->GetType() != ExpressionType::LogicExpression) {
+      continue;
+    }
+    std::vector<AbstractExpressionRef> disjuncts;
+    SplitLogic(conjuncts[i], LogicType::Or, disjuncts);
+    auto node = std::make_shared<BitmapIndexCondition>();
+    node->logic_type_ = LogicType::Or;
+    bool exact = true;
+    for (auto &disjunct : disjuncts) {
+      std::vector<AbstractExpressionRef> terms;
+      SplitLogic(disjunct, LogicType::And, terms);
+      std::vector<bool> terms_used(terms.size(), false);
+      auto child = MatchBitmap(indexes, terms, terms_used);
+      if (child == nullptr) {
+        node = nullptr;
+        break;
+      }
+      node->children_.push_back(child);
+      exact = exact && std::all_of(terms_used.begin(), terms_used.end(), [](bool term_used) { return term_used; });
+    }
+    if (node != nullptr) {
+      children.push_back(node);
+      // a term checked on the rows must check the whole OR again
+      used[i] = exact;
+    }
+  }
+  if (children.size() <= 1) {
+    return children.empty() ? nullptr : children[0];
+  }
+  auto node = std::make_shared<BitmapIndexCondition>();
+  node->logic_type_ = LogicType::And;
+  node->children_ = std::move(children);
+  return node;
+}
+
+IndexKeyRange Planner::MatchIndex(IndexInfo *index, const std::vector<AbstractExpressionRef> &conjuncts,
+                                  std::vector<bool> &used) {
+  IndexKeyRange range;
+  std::vector<bool> used_before = used;
+  // a conjunct is `column op constant`, the bound statements build nothing else
+  auto column_of = [&](size_t i) -> int64_t {
+    auto &conjunct = conjuncts[i];
+    if (used[i] || conjunct->GetType() != ExpressionType::ComparisonExpression ||
+        conjunct->GetChildAt(0)->GetType() != ExpressionType::ColumnExpression ||
+        conjunct->GetChildAt(1)->GetType() != ExpressionType::ConstantExpression ||
+        dynamic_pointer_cast<ConstantValueExpression>(conjunct->GetChildAt(1))->val_.IsNull()) {
+      return -1;
+    }
+    return dynamic_pointer_cast<ColumnValueExpression>(conjunct->GetChildAt(0))->GetColIdx();
+  };
+  auto op_of = [&](size_t i) { return dynamic_pointer_cast<ComparisonExpression>(conjuncts[i])->GetComparisonType(); };
+  for (auto column : index->GetIndexKeySchema()->GetColumns()) {
+    int64_t col_id = column->GetTableInd();
+    bool matched = false;
+    for (size_t i = 0; i < conjuncts.size() && !matched; i++) {
+      if (column_of(i) == col_id && op_of(i) == "=") {
+        range.prefix_.push_back(conjuncts[i]->GetChildAt(1));
+        used[i] = true;
+        matched = true;
+      }
+    }
+    if (matched) {
+      continue;
+    }
+    for (size_t i = 0; i < conjuncts.size(); i++) {
+      if (column_of(i) != col_id) {
+        continue;
+      }
+      std::string op = op_of(i);
+      if ((op == ">" || op == ">=") && range.lower_ == nullptr) {
+        range.lower_ = conjuncts[i]->GetChildAt(1);
+        range.lower_inclusive_ = op == ">=";
+        used[i] = true;
+      } else if ((op == "<" || op == "<=") && range.upper_ == nullptr) {
+        range.upper_ = conjuncts[i]->GetChildAt(1);
+        range.upper_inclusive_ = op == "<=";
+        used[i] = true;
       }
     }
+    break;
   }
-  if (available_index.empty() || statement->has_or) {
-    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
+  // a hash index only answers `=` on every key column
+  if (index->GetIndexType() == "hash" && range.prefix_.size() != index->GetIndexKeySchema()->GetColumnCount()) {
+    used = std::move(used_before);
+    return {};
   }
-  return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
-                                        available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
+  return range;
 }
 
 AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> statement) {
@@ -64,14 +276,14 @@ AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> stateme
 AbstractPlanNodeRef Planner::PlanDelete(std::shared_ptr<DeleteStatement> statement) {
   TableInfo *info = nullptr;
   context_->GetCatalog()->GetTable(statement->table_name_, info);
-  auto scan_plan = make_shared<SeqScanPlanNode>(info->GetSchema(), statement->table_name_, statement->where_);
+  auto scan_plan = PlanScan(statement->table_name_, info->GetSchema(), statement->where_, true);
   return std::make_shared<DeletePlanNode>(info->GetSchema(), scan_plan, statement->table_name_);
 }
 
 AbstractPlanNodeRef Planner::PlanUpdate(std::shared_ptr<UpdateStatement> statement) {
   TableInfo *info = nullptr;
   context_->GetCatalog()->GetTable(statement->table_name_, info);
-  auto scan_plan = make_shared<SeqScanPlanNode>(info->GetSchema(), statement->table_name_, statement->where_);
+  auto scan_plan = PlanScan(statement->table_name_, info->GetSchema(), statement->where_, true);
   return std::make_shared<UpdatePlanNode>(info->GetSchema(), scan_plan, statement->table_name_,
                                           statement->update_attrs);
 }
@@ -34,8 +34,10 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
 		// 	null_bitmap[i] = 0;
 		// }
 	}
-	MACH_WRITE_TO(bool*, buf, null_bitmap);
-	buf += num_fields * sizeof(bool);
+	for (uint32_t i = 0; i < num_fields; i++) {
+		MACH_WRITE_TO(bool, buf, null_bitmap[i]);
+		buf += sizeof(bool);
+	}
 	num_write_bytes += num_fields * sizeof(bool);
 	// fields
 	for (uint32_t i = 0; i < num_fields; i++) { // 最后一个个写
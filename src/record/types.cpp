@@ -1,5 +1,8 @@
 #include "record/types.h"
 
+#include <algorithm>
+#include <string>
+
 #include "common/macros.h"
 #include "record/field.h"
 
@@ -15,6 +18,25 @@ inline int CompareStrings(const char *str1, int len1, const char *str2, int len2
   return ret;
 }
 
+/**
+ * Index keys store fixed size values big-endian with the sign bit flipped, so that the bytes compare like the
+ * values when read as unsigned bytes.
+ */
+inline void WriteKeyUint32(char *buf, uint32_t val) {
+  for (int i = 3; i >= 0; i--) {
+    buf[i] = static_cast<char>(val & 0xFF);
+    val >>= 8;
+  }
+}
+
+inline uint32_t ReadKeyUint32(const char *buf) {
+  uint32_t val = 0;
+  for (int i = 0; i < 4; i++) {
+    val = (val << 8) | static_cast<uint8_t>(buf[i]);
+  }
+  return val;
+}
+
 // ==============================Type=============================
 
 Type *Type::type_singletons_[] = {new Type(TypeId::kTypeInvalid), new TypeInt(), new TypeFloat(), new TypeChar()};
@@ -34,6 +56,21 @@ uint32_t Type::GetSerializedSize(const Field &field, bool is_null) const {
   return 0;
 }
 
+uint32_t Type::SerializeToKey([[maybe_unused]] const Field &field, [[maybe_unused]] char *buf) const {
+  ASSERT(false, "SerializeToKey not implemented.");
+  return 0;
+}
+
+uint32_t Type::DeserializeFromKey([[maybe_unused]] char *storage, [[maybe_unused]] Field **field) const {
+  ASSERT(false, "DeserializeFromKey not implemented.");
+  return 0;
+}
+
+uint32_t Type::GetKeySerializedSize([[maybe_unused]] const Field &field) const {
+  ASSERT(false, "GetKeySerializedSize not implemented.");
+  return 0;
+}
+
 const char *Type::GetData(const Field &val) const {
   ASSERT(false, "GetData not implemented.");
   return nullptr;
@@ -94,13 +131,27 @@ uint32_t TypeInt::DeserializeFrom(char *storage, Field **field, bool is_null) co
   return GetTypeSize(type_id_);
 }
 
-uint32_t TypeInt::GetSerializedSize(const Field &field, bool is_null) const {
+uint32_t TypeInt::GetSerializedSize([[maybe_unused]] const Field &field, bool is_null) const {
   if (is_null) {
     return 0;
   }
   return GetTypeSize(type_id_);
 }
 
+uint32_t TypeInt::SerializeToKey(const Field &field, char *buf) const {
+  WriteKeyUint32(buf, static_cast<uint32_t>(field.value_.integer_) ^ 0x80000000u);
+  return GetTypeSize(type_id_);
+}
+
+uint32_t TypeInt::DeserializeFromKey(char *storage, Field **field) const {
+  *field = new Field(TypeId::kTypeInt, static_cast<int32_t>(ReadKeyUint32(storage) ^ 0x80000000u));
+  return GetTypeSize(type_id_);
+}
+
+uint32_t TypeInt::GetKeySerializedSize([[maybe_unused]] const Field &field) const {
+  return GetTypeSize(type_id_);
+}
+
 CmpBool TypeInt::CompareEquals(const Field &left, const Field &right) const {
   ASSERT(left.CheckComparable(right), "Not comparable.");
   if (left.IsNull() || right.IsNull()) {
@@ -169,13 +220,39 @@ uint32_t TypeFloat::DeserializeFrom(char *storage, Field **field, bool is_null)
   return GetTypeSize(type_id_);
 }
 
-uint32_t TypeFloat::GetSerializedSize(const Field &field, bool is_null) const {
+uint32_t TypeFloat::GetSerializedSize([[maybe_unused]] const Field &field, bool is_null) const {
   if (is_null) {
     return 0;
   }
   return GetTypeSize(type_id_);
 }
 
+/**
+ * Positive floats get the sign bit set, negative floats get all bits flipped, so larger magnitudes sort first among
+ * the negatives. -0.0 is stored as 0.0 since the two compare equal.
+ */
+uint32_t TypeFloat::SerializeToKey(const Field &field, char *buf) const {
+  float val = field.value_.float_ == 0.0f ? 0.0f : field.value_.float_;
+  uint32_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+  WriteKeyUint32(buf, bits);
+  return GetTypeSize(type_id_);
+}
+
+uint32_t TypeFloat::DeserializeFromKey(char *storage, Field **field) const {
+  uint32_t bits = ReadKeyUint32(storage);
+  bits = (bits & 0x80000000u) ? (bits & 0x7FFFFFFFu) : ~bits;
+  float val;
+  memcpy(&val, &bits, sizeof(val));
+  *field = new Field(TypeId::kTypeFloat, val);
+  return GetTypeSize(type_id_);
+}
+
+uint32_t TypeFloat::GetKeySerializedSize([[maybe_unused]] const Field &field) const {
+  return GetTypeSize(type_id_);
+}
+
 CmpBool TypeFloat::CompareEquals(const Field &left, const Field &right) const {
   ASSERT(left.CheckComparable(right), "Not comparable.");
   if (left.IsNull() || right.IsNull()) {
@@ -253,6 +330,42 @@ uint32_t TypeChar::GetSerializedSize(const Field &field, bool is_null) const {
   return len + sizeof(uint32_t);
 }
 
+/**
+ * The bytes of the string followed by 0x00 0x00, a 0x00 inside the string is written as 0x00 0xFF. A string then
+ * sorts before every longer string it is a prefix of, like in CompareStrings.
+ */
+uint32_t TypeChar::SerializeToKey(const Field &field, char *buf) const {
+  uint32_t len = GetLength(field);
+  const char *data = GetData(field);
+  char *out = buf;
+  for (uint32_t i = 0; i < len; i++) {
+    *out++ = data[i];
+    if (data[i] == '\0') {
+      *out++ = static_cast<char>(0xFF);
+    }
+  }
+  *out++ = '\0';
+  *out++ = '\0';
+  return out - buf;
+}
+
+uint32_t TypeChar::DeserializeFromKey(char *storage, Field **field) const {
+  std::string val;
+  char *in = storage;
+  while (!(in[0] == '\0' && in[1] == '\0')) {
+    val.push_back(in[0]);
+    in += (in[0] == '\0') ? 2 : 1;
+  }
+  *field = new Field(TypeId::kTypeChar, const_cast<char *>(val.data()), val.size(), true);
+  return in + 2 - storage;
+}
+
+uint32_t TypeChar::GetKeySerializedSize(const Field &field) const {
+  uint32_t len = GetLength(field);
+  const char *data = GetData(field);
+  return len + std::count(data, data + len, '\0') + 2;
+}
+
 const char *TypeChar::GetData(const Field &val) const {
   return val.value_.chars_;
 }
@@ -1,36 +1,46 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 #include <stdexcept>
+#include <thread>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, uint32_t io_queue_depth) : file_name_(db_file) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    std::filesystem::path p = db_file;
-    if(p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
+  // create the directory if it does not exist, the file itself is created by open
+  std::filesystem::path p = db_file;
+  if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw std::runtime_error("Cannot open db file " + db_file + ": " + strerror(errno));
+  }
+  int64_t file_size = GetFileSize(file_name_);
+  file_size_ = file_size < 0 ? 0 : static_cast<size_t>(file_size);
+  LoadSpaceMap();
+  if (io_queue_depth > 0) {
+    io_uring_ = std::make_unique<IOUring>(io_queue_depth);
+    if (!io_uring_->IsValid()) {
+      io_uring_.reset();
     }
   }
-  ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    FlushMetaData();
+    io_uring_.reset();
+    close(db_fd_);
+    db_fd_ = -1;
     closed = true;
   }
 }
@@ -50,120 +60,441 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
  * 从磁盘中分配一个空闲页，并返回空闲页的逻辑页号
  */
 page_id_t DiskManager::AllocatePage() {
-	int32_t logical_page_id = INVALID_PAGE_ID;
-	DiskFileMetaPage* meta_page_ = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-
-	for (uint32_t i = 0; i < (PAGE_SIZE - 8) / 4; i++) {
-		if (meta_page_->extent_used_page_[i] < BitmapPage<PAGE_SIZE>::GetMaxSupportedSize()) {
-			BitmapPage<PAGE_SIZE> *bitmap = new BitmapPage<PAGE_SIZE>;
-			ReadPhysicalPage(i * (BITMAP_SIZE + 1) + 1, (char*)bitmap); // Read
-			
-			uint32_t offset;
-			bitmap->AllocatePage(offset);
-			WritePhysicalPage(i * (BITMAP_SIZE + 1) +1, (char*)bitmap);
-			delete bitmap;
-			meta_page_->num_allocated_pages_++;
-			if (meta_page_->extent_used_page_[i] == 0) {
-      			meta_page_->num_extents_++;
-      		}
-			meta_page_->extent_used_page_[i]++;
-			WritePhysicalPage(META_PAGE_ID, meta_data_);
-			logical_page_id = i * BITMAP_SIZE + offset;
-			break;
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	if (reserved_runs_.empty()) {
+		// the lowest extent with room, found through the directory instead of a scan over the meta pages
+		uint32_t extent_id = free_extents_.empty() ? next_extent_ : *free_extents_.begin();
+		uint32_t offset;
+		if (extent_id >= MAX_EXTENTS || !GetBitmap(extent_id)->AllocatePage(offset)) {
+			return INVALID_PAGE_ID;
+		}
+		page_id_t page_id = extent_id * BITMAP_SIZE + offset;
+		MarkAllocated(page_id);
+		return page_id;
+	}
+	page_id_t page_id = FindFreeRun(1);
+	if (page_id == INVALID_PAGE_ID) {
+		// only reserved pages are left, runs are a layout hint and must not make the file run out of space
+		reserved_runs_.clear();
+		return AllocatePage();
+	}
+	GetBitmap(page_id / BITMAP_SIZE)->AllocatePageAt(page_id % BITMAP_SIZE);
+	MarkAllocated(page_id);
+	return page_id;
+}
+
+page_id_t DiskManager::AllocatePage(page_id_t near_page_id) {
+	if (near_page_id == INVALID_PAGE_ID) {
+		return AllocatePage();
+	}
+	std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+	page_id_t page_id = near_page_id + 1;
+	if (static_cast<uint32_t>(page_id) / BITMAP_SIZE >= MAX_EXTENTS) {
+		return AllocatePage();
+	}
+	// keep growing into the run reserved behind near_page_id
+	auto run = reserved_runs_.find(page_id);
+	if (run != reserved_runs_.end()) {
+		page_id_t run_end = run->second;
+		reserved_runs_.erase(run);
+		if (GetBitmap(page_id / BITMAP_SIZE)->AllocatePageAt(page_id % BITMAP_SIZE)) {
+			if (page_id + 1 < run_end) {
+				reserved_runs_.emplace(page_id + 1, run_end);
+			}
+			MarkAllocated(page_id);
+			return page_id;
+		}
+	}
+	// start a new run, right behind near_page_id if that page is available, else in the first window of free pages
+	uint32_t run_size;
+	if (IsPageFree(page_id) && !IsPageReserved(page_id)) {
+		run_size = FreeRunLength(page_id, EXTENT_RUN_SIZE);
+	} else {
+		page_id = FindFreeRun(EXTENT_RUN_SIZE);
+		if (page_id == INVALID_PAGE_ID) {
+			return AllocatePage();
 		}
+		run_size = EXTENT_RUN_SIZE;
+	}
+	GetBitmap(page_id / BITMAP_SIZE)->AllocatePageAt(page_id % BITMAP_SIZE);
+	MarkAllocated(page_id);
+	if (run_size > 1) {
+		reserved_runs_.emplace(page_id + 1, page_id + run_size);
 	}
-  	return logical_page_id;
+	Preallocate(page_id, page_id + run_size);
+	return page_id;
 }
 
 /**
  * TODO: Student Implement
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
-    DiskFileMetaPage *meta_page_ = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
     uint32_t extent = logical_page_id / BITMAP_SIZE;
     uint32_t offset = logical_page_id % BITMAP_SIZE;
-    uint32_t physical_page_id = MapPageId(logical_page_id);
-    BitmapPage<PAGE_SIZE> *bitmap = new BitmapPage<PAGE_SIZE>;
-    ReadPhysicalPage(physical_page_id, (char*)bitmap);
-    bitmap->DeAllocatePage(offset);
-    WritePhysicalPage(physical_page_id, (char*)bitmap);
-    delete bitmap;
-    meta_page_->num_allocated_pages_--;
-    meta_page_->extent_used_page_[extent]--;
-    if (meta_page_->extent_used_page_[extent] == 0) {
-        meta_page_->num_extents_--;
-    }
-    WritePhysicalPage(META_PAGE_ID, meta_data_);
-
-    return;
+    // page is already free, nothing to update
+    if (extent >= MAX_EXTENTS || !GetBitmap(extent)->DeAllocatePage(offset)) {
+        return;
+    }
+    bitmap_dirty_[extent] = true;
+    UpdateExtentUsage(extent, -1);
 }
 
 /**
  * TODO: Student Implement
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-    bool flag = false;
-    BitmapPage<PAGE_SIZE> *bitmap = new BitmapPage<PAGE_SIZE>;
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
     uint32_t extent_id = logical_page_id / BITMAP_SIZE;
     uint32_t offset_id = logical_page_id % BITMAP_SIZE;
-    uint32_t physical_page_id = extent_id * (BITMAP_SIZE + 1) + 1;
-    ReadPhysicalPage(physical_page_id, (char*)bitmap);
-    flag = bitmap->IsPageFree(offset_id);
-    delete bitmap;
-    return flag;
+    if (extent_id >= MAX_EXTENTS) {
+        return true;
+    }
+    return GetBitmap(extent_id)->IsPageFree(offset_id);
+}
+
+void DiskManager::MarkAllocated(page_id_t logical_page_id) {
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  bitmap_dirty_[extent_id] = true;
+  UpdateExtentUsage(extent_id, 1);
+}
+
+void DiskManager::UpdateExtentUsage(uint32_t extent_id, int32_t delta) {
+  uint32_t group_id = extent_id / EXTENTS_PER_META;
+  DiskFileMetaPage *meta_page = GetMetaPage(group_id);
+  uint32_t &used = meta_page->extent_used_page_[extent_id % EXTENTS_PER_META];
+  if (used == 0) {
+    meta_page->num_extents_++;
+  }
+  used += delta;
+  meta_page->num_allocated_pages_ += delta;
+  if (used == 0) {
+    meta_page->num_extents_--;
+  }
+  meta_dirty_[group_id] = true;
+  // keep the directory of extents with room in sync
+  while (next_extent_ <= extent_id) {
+    free_extents_.insert(next_extent_++);
+  }
+  if (used >= BITMAP_SIZE) {
+    free_extents_.erase(extent_id);
+  } else {
+    free_extents_.insert(extent_id);
+  }
+}
+
+bool DiskManager::IsPageReserved(page_id_t logical_page_id) {
+  auto run = reserved_runs_.upper_bound(logical_page_id);
+  return run != reserved_runs_.begin() && std::prev(run)->second > logical_page_id;
+}
+
+uint32_t DiskManager::FreeRunLength(page_id_t logical_page_id, uint32_t max_length) {
+  // a run stops at the end of the extent, at the first page in use and at the next reserved run
+  auto next_run = reserved_runs_.upper_bound(logical_page_id);
+  page_id_t limit = static_cast<page_id_t>((logical_page_id / BITMAP_SIZE + 1) * BITMAP_SIZE);
+  if (next_run != reserved_runs_.end() && next_run->first < limit) {
+    limit = next_run->first;
+  }
+  BitmapPage<PAGE_SIZE> *bitmap = GetBitmap(logical_page_id / BITMAP_SIZE);
+  uint32_t length = 0;
+  while (length < max_length && logical_page_id + static_cast<page_id_t>(length) < limit &&
+         bitmap->IsPageFree((logical_page_id + length) % BITMAP_SIZE)) {
+    length++;
+  }
+  return length;
+}
+
+page_id_t DiskManager::FindFreeRun(uint32_t run_size) {
+  auto try_extent = [&](uint32_t extent_id) {
+    if (BITMAP_SIZE - GetExtentUsedPages(extent_id) < run_size) {
+      return INVALID_PAGE_ID;
+    }
+    BitmapPage<PAGE_SIZE> *bitmap = GetBitmap(extent_id);
+    uint32_t offset = 0;
+    uint32_t free_offset;
+    while (bitmap->FindFreePage(offset, BITMAP_SIZE, free_offset)) {
+      page_id_t page_id = extent_id * BITMAP_SIZE + free_offset;
+      auto run = reserved_runs_.upper_bound(page_id);
+      if (run != reserved_runs_.begin() && std::prev(run)->second > page_id) {
+        // skip over the run this page is reserved for
+        offset = std::prev(run)->second - extent_id * BITMAP_SIZE;
+        continue;
+      }
+      uint32_t length = FreeRunLength(page_id, run_size);
+      if (length >= run_size) {
+        return page_id;
+      }
+      offset = free_offset + length;
+    }
+    return INVALID_PAGE_ID;
+  };
+  for (uint32_t extent_id : free_extents_) {
+    page_id_t page_id = try_extent(extent_id);
+    if (page_id != INVALID_PAGE_ID) {
+      return page_id;
+    }
+  }
+  // extents past the directory have never been used, so nothing can be reserved in them
+  return next_extent_ < MAX_EXTENTS ? static_cast<page_id_t>(next_extent_ * BITMAP_SIZE) : INVALID_PAGE_ID;
+}
+
+void DiskManager::Preallocate(page_id_t first_page_id, page_id_t end_page_id) {
+  size_t begin = MapPageId(first_page_id) * PAGE_SIZE;
+  size_t end = MapPageId(end_page_id - 1) * PAGE_SIZE + PAGE_SIZE;
+  if (end <= file_size_.load()) {
+    return;
+  }
+  begin = std::max(begin, file_size_.load());
+  // reserve the blocks in one go so the file system can lay the run out contiguously. Not every file system supports
+  // it, the pages are then simply allocated as they are written.
+  if (fallocate(db_fd_, 0, begin, end - begin) == 0) {
+    ExtendFileSize(end);
+  }
+}
+
+void DiskManager::FlushMetaData() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  for (uint32_t i = 0; i < bitmaps_.size(); i++) {
+    if (bitmap_dirty_[i]) {
+      WritePhysicalPage(GetBitmapPhysicalId(i), reinterpret_cast<char *>(bitmaps_[i].get()));
+      bitmap_dirty_[i] = false;
+    }
+  }
+  for (uint32_t i = 0; i < meta_pages_.size(); i++) {
+    if (meta_dirty_[i]) {
+      WritePhysicalPage(GetMetaPhysicalId(i), meta_pages_[i].get());
+      meta_dirty_[i] = false;
+    }
+  }
+}
+
+void DiskManager::LoadSpaceMap() {
+  // the meta page of every group the file reaches into, files written before groups existed only have group 0
+  uint32_t num_groups = 1;
+  while (num_groups < NUM_META_GROUPS && GetMetaPhysicalId(num_groups) * PAGE_SIZE < file_size_.load()) {
+    num_groups++;
+  }
+  for (uint32_t group_id = 0; group_id < num_groups; group_id++) {
+    DiskFileMetaPage *meta_page = GetMetaPage(group_id);
+    if (meta_page->num_extents_ == 0) {
+      continue;
+    }
+    for (uint32_t i = 0; i < EXTENTS_PER_META; i++) {
+      if (meta_page->extent_used_page_[i] > 0) {
+        next_extent_ = group_id * EXTENTS_PER_META + i + 1;
+      }
+    }
+  }
+  for (uint32_t extent_id = 0; extent_id < next_extent_; extent_id++) {
+    if (GetExtentUsedPages(extent_id) < BITMAP_SIZE) {
+      free_extents_.insert(extent_id);
+    }
+  }
+}
+
+DiskFileMetaPage *DiskManager::GetMetaPage(uint32_t group_id) {
+  if (group_id >= meta_pages_.size()) {
+    meta_pages_.resize(group_id + 1);
+    meta_dirty_.resize(group_id + 1, false);
+  }
+  if (meta_pages_[group_id] == nullptr) {
+    meta_pages_[group_id] = std::make_unique<char[]>(PAGE_SIZE);
+    ReadPhysicalPage(GetMetaPhysicalId(group_id), meta_pages_[group_id].get());
+  }
+  return reinterpret_cast<DiskFileMetaPage *>(meta_pages_[group_id].get());
+}
+
+uint32_t DiskManager::GetExtentUsedPages(uint32_t extent_id) {
+  return GetMetaPage(extent_id / EXTENTS_PER_META)->extent_used_page_[extent_id % EXTENTS_PER_META];
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  if (extent_id >= bitmaps_.size()) {
+    bitmaps_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    bitmaps_[extent_id] = std::make_unique<BitmapPage<PAGE_SIZE>>();
+    ReadPhysicalPage(GetBitmapPhysicalId(extent_id), reinterpret_cast<char *>(bitmaps_[extent_id].get()));
+  }
+  return bitmaps_[extent_id].get();
+}
+
+uint64_t DiskManager::GetMetaPhysicalId(uint32_t group_id) {
+  return META_PAGE_ID + static_cast<uint64_t>(group_id) * (1 + EXTENTS_PER_META * (BITMAP_SIZE + 1));
+}
+
+uint64_t DiskManager::GetBitmapPhysicalId(uint32_t extent_id) {
+  return GetMetaPhysicalId(extent_id / EXTENTS_PER_META) + 1 + (extent_id % EXTENTS_PER_META) * (BITMAP_SIZE + 1);
 }
 
 /**
  * TODO: Student Implement
  */
-page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
-    uint32_t physical_page_id = 0;
+uint64_t DiskManager::MapPageId(page_id_t logical_page_id) {
     uint32_t extent_id = logical_page_id / BITMAP_SIZE;
     uint32_t offset_id = logical_page_id % BITMAP_SIZE;
-    uint32_t bitmap_id = extent_id * (BITMAP_SIZE + 1) + 1;
-    physical_page_id = bitmap_id + offset_id + 1;
-    return physical_page_id;
+    return GetBitmapPhysicalId(extent_id) + offset_id + 1;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
   return rc == 0 ? stat_buf.st_size : -1;
 }
 
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+void DiskManager::ReadPhysicalPage(uint64_t physical_page_id, char *page_data) {
+  size_t offset = physical_page_id * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file_size_.load()) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while reading: " << strerror(errno);
+      break;
+    }
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+}
+
+void DiskManager::WritePhysicalPage(uint64_t physical_page_id, const char *page_data) {
+  size_t offset = physical_page_id * PAGE_SIZE;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t rc = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
     }
+    // check for I/O error
+    if (rc <= 0) {
+      LOG(ERROR) << "I/O error while writing: " << strerror(errno);
+      return;
+    }
+    write_count += rc;
   }
+  ExtendFileSize(offset + PAGE_SIZE);
 }
 
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
+void DiskManager::ExtendFileSize(size_t end) {
+  // writes may race so only ever grow it
+  size_t cur = file_size_.load();
+  while (cur < end && !file_size_.compare_exchange_weak(cur, end)) {
+  }
+}
+
+size_t DiskManager::ReapCompletions(std::vector<PageIORequest> &requests, std::vector<bool> &done) {
+  size_t reaped = 0;
+  uint64_t index;
+  int32_t res;
+  while (io_uring_->PopCompletion(&index, &res)) {
+    auto &request = requests[index];
+    uint64_t physical_page_id = MapPageId(request.logical_page_id_);
+    if (request.is_write_) {
+      if (res == PAGE_SIZE) {
+        ExtendFileSize(physical_page_id * PAGE_SIZE + PAGE_SIZE);
+      } else {
+        // short or failed write (or a kernel without IORING_OP_WRITE), the synchronous path handles both
+        WritePhysicalPage(physical_page_id, request.data_);
+      }
+    } else if (res < PAGE_SIZE) {
+      // short or failed read, the synchronous path zero fills past the end of file and logs errors
+      ReadPhysicalPage(physical_page_id, request.data_);
+    }
+    if (request.callback_) request.callback_();
+    done[index] = true;
+    reaped++;
+  }
+  return reaped;
+}
+
+void DiskManager::ExecuteBatch(std::vector<PageIORequest> &requests) {
+  std::unique_lock<std::mutex> lock(io_uring_latch_);
+  std::vector<bool> done(requests.size(), false);
+  if (io_uring_ != nullptr) {
+    size_t next = 0;
+    size_t in_flight = 0, completed = 0;
+    while (completed < requests.size()) {
+      // keep the submission queue full
+      while (next < requests.size() && in_flight < io_uring_->GetNumEntries()) {
+        auto &request = requests[next];
+        ASSERT(request.logical_page_id_ >= 0, "Invalid page id.");
+        size_t offset = MapPageId(request.logical_page_id_) * PAGE_SIZE;
+        if (!request.is_write_ && offset >= file_size_.load()) {
+          // nothing on disk yet, same as ReadPhysicalPage
+          memset(request.data_, 0, PAGE_SIZE);
+          if (request.callback_) request.callback_();
+          done[next] = true;
+          completed++;
+        } else {
+          if (request.is_write_) {
+            io_uring_->PrepareWrite(db_fd_, request.data_, PAGE_SIZE, offset, next);
+          } else {
+            io_uring_->PrepareRead(db_fd_, request.data_, PAGE_SIZE, offset, next);
+          }
+          in_flight++;
+        }
+        next++;
+      }
+      if (in_flight == 0) {
+        continue;
+      }
+      if (!io_uring_->Submit(1)) {
+        // the ring is broken, stop using it and redo whatever has not completed synchronously below. The kernel may
+        // still be reading into or writing from the buffers of requests it already took, so reap all of them first:
+        // a stale write landing after the synchronous one would put old data on disk.
+        LOG(ERROR) << "io_uring failed, falling back to synchronous I/O";
+        size_t submitted = in_flight - io_uring_->GetNumUnsubmitted();
+        while (submitted > 0) {
+          size_t reaped = ReapCompletions(requests, done);
+          submitted -= reaped;
+          completed += reaped;
+          if (reaped == 0 && submitted > 0 && !io_uring_->Wait(1)) {
+            // completions of requests run by kernel workers still show up, poll for them
+            std::this_thread::yield();
+          }
+        }
+        io_uring_.reset();
+        break;
+      }
+      size_t reaped = ReapCompletions(requests, done);
+      in_flight -= reaped;
+      completed += reaped;
+    }
+    if (io_uring_ != nullptr) {
+      return;
+    }
+  }
+  lock.unlock();
+  for (size_t i = 0; i < requests.size(); i++) {
+    if (done[i]) {
+      continue;
+    }
+    auto &request = requests[i];
+    if (request.is_write_) {
+      WritePage(request.logical_page_id_, request.data_);
+    } else {
+      ReadPage(request.logical_page_id_, request.data_);
+    }
+    if (request.callback_) request.callback_();
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+}
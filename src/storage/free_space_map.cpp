@@ -0,0 +1,55 @@
+#include "storage/free_space_map.h"
+
+#include <algorithm>
+
+void FreeSpaceMap::Update(page_id_t page_id, uint32_t free_space) {
+  uint32_t bucket = std::min(free_space / BUCKET_SIZE, NUM_BUCKETS - 1);
+  auto iter = page_bucket_.find(page_id);
+  if (iter != page_bucket_.end()) {
+    if (iter->second == bucket) {
+      return;
+    }
+    Remove(page_id);
+  }
+  // pages in bucket 0 cannot be guaranteed to fit anything, there is no point in remembering them
+  if (bucket == 0) {
+    return;
+  }
+  buckets_[bucket].insert(page_id);
+  page_bucket_.emplace(page_id, bucket);
+  non_empty_buckets_ |= 1ULL << bucket;
+}
+
+void FreeSpaceMap::Remove(page_id_t page_id) {
+  auto iter = page_bucket_.find(page_id);
+  if (iter == page_bucket_.end()) {
+    return;
+  }
+  uint32_t bucket = iter->second;
+  buckets_[bucket].erase(page_id);
+  if (buckets_[bucket].empty()) {
+    non_empty_buckets_ &= ~(1ULL << bucket);
+  }
+  page_bucket_.erase(iter);
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size) const {
+  // every page of bucket b has at least b * BUCKET_SIZE free bytes, so start at the first bucket that guarantees size
+  uint32_t first_bucket = (size + BUCKET_SIZE - 1) / BUCKET_SIZE;
+  if (first_bucket >= NUM_BUCKETS) {
+    return INVALID_PAGE_ID;
+  }
+  uint64_t candidates = non_empty_buckets_ & (~0ULL << first_bucket);
+  if (candidates == 0) {
+    return INVALID_PAGE_ID;
+  }
+  return *buckets_[__builtin_ctzll(candidates)].begin();
+}
+
+void FreeSpaceMap::Clear() {
+  for (auto &bucket : buckets_) {
+    bucket.clear();
+  }
+  page_bucket_.clear();
+  non_empty_buckets_ = 0;
+}
@@ -0,0 +1,177 @@
+#include "storage/io_uring.h"
+
+#ifdef ENABLE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "glog/logging.h"
+
+IOUring::IOUring(uint32_t entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (fd < 0) {
+    LOG(WARNING) << "io_uring is unavailable: " << strerror(errno);
+    return;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // newer kernels map both rings with one mmap
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    close(fd);
+    return;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      munmap(sq_ring_, sq_ring_size_);
+      sq_ring_ = nullptr;
+      close(fd);
+      return;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    if (!single_mmap) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = cq_ring_ = nullptr;
+    close(fd);
+    return;
+  }
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_head_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  sq_entries_ = params.sq_entries;
+  ring_fd_ = fd;
+}
+
+IOUring::~IOUring() {
+  if (!IsValid()) {
+    return;
+  }
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IOUring::PrepareRead(int fd, char *buf, uint32_t len, uint64_t offset, uint64_t user_data) {
+  return Prepare(IORING_OP_READ, fd, reinterpret_cast<uint64_t>(buf), len, offset, user_data);
+}
+
+bool IOUring::PrepareWrite(int fd, const char *buf, uint32_t len, uint64_t offset, uint64_t user_data) {
+  return Prepare(IORING_OP_WRITE, fd, reinterpret_cast<uint64_t>(buf), len, offset, user_data);
+}
+
+bool IOUring::Prepare(uint8_t opcode, int fd, uint64_t addr, uint32_t len, uint64_t offset, uint64_t user_data) {
+  // only this thread moves the tail, the kernel moves the head as it consumes entries
+  uint32_t tail = *sq_tail_;
+  uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (tail - head >= sq_entries_) {
+    return false;
+  }
+  uint32_t index = tail & *sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  to_submit_++;
+  return true;
+}
+
+bool IOUring::Submit(uint32_t wait_nr) {
+  uint32_t flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+  while (true) {
+    int rc = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit_, wait_nr, flags, nullptr, 0));
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+      return false;
+    }
+    to_submit_ -= static_cast<uint32_t>(rc);
+    return true;
+  }
+}
+
+bool IOUring::Wait(uint32_t wait_nr) {
+  while (true) {
+    int rc = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, 0, wait_nr, IORING_ENTER_GETEVENTS, nullptr, 0));
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+      return false;
+    }
+    return true;
+  }
+}
+
+bool IOUring::PopCompletion(uint64_t *user_data, int32_t *res) {
+  uint32_t head = *cq_head_;
+  uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  if (head == tail) {
+    return false;
+  }
+  auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+  *user_data = cqe->user_data;
+  *res = cqe->res;
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+#else
+
+IOUring::IOUring(__attribute__((unused)) uint32_t entries) {}
+
+IOUring::~IOUring() = default;
+
+bool IOUring::PrepareRead(int, char *, uint32_t, uint64_t, uint64_t) { return false; }
+
+bool IOUring::PrepareWrite(int, const char *, uint32_t, uint64_t, uint64_t) { return false; }
+
+bool IOUring::Submit(uint32_t) { return false; }
+
+bool IOUring::Wait(uint32_t) { return false; }
+
+bool IOUring::PopCompletion(uint64_t *, int32_t *) { return false; }
+
+bool IOUring::Prepare(uint8_t, int, uint64_t, uint32_t, uint64_t, uint64_t) { return false; }
+
+#endif  // ENABLE_IO_URING
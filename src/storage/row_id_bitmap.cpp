@@ -0,0 +1,93 @@
+#include "storage/row_id_bitmap.h"
+
+#include <algorithm>
+
+bool RowIdBitmap::Add(const RowId &rid) {
+  SlotWords &words = pages_[rid.GetPageId()];
+  uint32_t word = rid.GetSlotNum() / 64;
+  uint64_t bit = 1ULL << (rid.GetSlotNum() % 64);
+  if (words.size() <= word) {
+    words.resize(word + 1, 0);
+  }
+  if (words[word] & bit) {
+    return false;
+  }
+  words[word] |= bit;
+  size_++;
+  return true;
+}
+
+bool RowIdBitmap::Contains(const RowId &rid) const {
+  auto iter = pages_.find(rid.GetPageId());
+  if (iter == pages_.end()) {
+    return false;
+  }
+  uint32_t word = rid.GetSlotNum() / 64;
+  return word < iter->second.size() && (iter->second[word] >> (rid.GetSlotNum() % 64) & 1);
+}
+
+void RowIdBitmap::IntersectWith(const RowIdBitmap &other) {
+  auto other_iter = other.pages_.begin();
+  for (auto iter = pages_.begin(); iter != pages_.end();) {
+    // both maps are in page order, walk them side by side
+    while (other_iter != other.pages_.end() && other_iter->first < iter->first) {
+      ++other_iter;
+    }
+    SlotWords &words = iter->second;
+    size_ -= CountSlots(words);
+    if (other_iter == other.pages_.end() || other_iter->first != iter->first) {
+      iter = pages_.erase(iter);
+      continue;
+    }
+    const SlotWords &other_words = other_iter->second;
+    words.resize(std::min(words.size(), other_words.size()));
+    for (size_t w = 0; w < words.size(); w++) {
+      words[w] &= other_words[w];
+    }
+    size_t count = CountSlots(words);
+    if (count == 0) {
+      iter = pages_.erase(iter);
+      continue;
+    }
+    size_ += count;
+    ++iter;
+  }
+}
+
+void RowIdBitmap::UnionWith(const RowIdBitmap &other) {
+  auto hint = pages_.begin();
+  for (auto &other_page : other.pages_) {
+    hint = pages_.try_emplace(hint, other_page.first);
+    SlotWords &words = hint->second;
+    const SlotWords &other_words = other_page.second;
+    size_ -= CountSlots(words);
+    if (words.size() < other_words.size()) {
+      words.resize(other_words.size(), 0);
+    }
+    for (size_t w = 0; w < other_words.size(); w++) {
+      words[w] |= other_words[w];
+    }
+    size_ += CountSlots(words);
+  }
+}
+
+size_t RowIdBitmap::CountSlots(const SlotWords &words) {
+  size_t count = 0;
+  for (auto word : words) {
+    count += __builtin_popcountll(word);
+  }
+  return count;
+}
+
+void RowIdBitmap::CollectSlots(const SlotWords &words, std::vector<uint32_t> &slots) {
+  for (uint32_t w = 0; w < words.size(); w++) {
+    for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+      slots.push_back(w * 64 + __builtin_ctzll(bits));
+    }
+  }
+}
+
+void RowIdBitmap::Clear() {
+  pages_.clear();
+  size_ = 0;
+}
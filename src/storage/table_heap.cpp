@@ -4,37 +4,123 @@
  * TODO: Student Implement
  */
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-	bool flag = false;
-	TablePage* current_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(GetCurrentPageId()));
-	if (current_page == nullptr) {
-		flag = false;
-	} else {
-		while (current_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_) == false) {
-			page_id_t next_page_id = current_page->GetNextPageId();
-			if (next_page_id == INVALID_PAGE_ID) { // 最后一个数据页
-				// 分配新的数据页
-				TablePage* new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-				if (new_page == nullptr) {
-					buffer_pool_manager_->UnpinPage(current_page->GetTablePageId(), false); // Unpin
-					return false; // 
-				} else {
-					new_page->Init(next_page_id, current_page->GetPageId(), log_manager_, txn);
-					current_page->SetNextPageId(next_page_id);
-					buffer_pool_manager_->UnpinPage(current_page->GetTablePageId(), true);
-					current_page = new_page;					
+	uint32_t serialized_size = row.GetSerializedSize(schema_);
+	if (serialized_size > TablePage::SIZE_MAX_ROW) {
+		return false;
+	}
+	LoadFreeSpaceMap();
+	while (true) {
+		// go straight to a page with room, append a page only if there is none
+		page_id_t page_id = free_space_map_.FindPage(serialized_size + TablePage::SIZE_TUPLE);
+		bool new_page = page_id == INVALID_PAGE_ID;
+		TablePage *page = new_page ? AppendPage(txn)
+		                           : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+		if (page == nullptr) {
+			return false;
+		}
+		bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+		// the map is only a hint, whatever happened it now knows the page's real free space
+		free_space_map_.Update(page->GetTablePageId(), page->GetFreeSpaceRemaining());
+		buffer_pool_manager_->UnpinPage(page->GetTablePageId(), inserted || new_page);
+		if (inserted) {
+			current_page_id_ = page->GetTablePageId();
+			return true;
+		}
+		if (new_page) {
+			return false;
+		}
+	}
+}
+
+bool TableHeap::BulkInsert(std::vector<Row> &rows, Transaction *txn) {
+	LoadFreeSpaceMap();
+	TablePage *page = nullptr;
+	bool new_page = false;
+	bool page_dirty = false;
+	size_t inserted = 0;
+	auto release_page = [&]() {
+		free_space_map_.Update(page->GetTablePageId(), page->GetFreeSpaceRemaining());
+		buffer_pool_manager_->UnpinPage(page->GetTablePageId(), page_dirty || new_page);
+		page = nullptr;
+	};
+	// 失败时删掉本批已插入的行, 要么全部插入要么一行都不插入
+	auto rollback = [&]() {
+		if (page != nullptr) {
+			release_page();
+		}
+		for (size_t i = 0; i < inserted; i++) {
+			ApplyDelete(rows[i].GetRowId(), txn);
+		}
+		return false;
+	};
+	for (auto &row : rows) {
+		uint32_t serialized_size = row.GetSerializedSize(schema_);
+		if (serialized_size > TablePage::SIZE_MAX_ROW) {
+			return rollback();
+		}
+		// stay on the pinned page as long as rows fit, then move on to the next page with room
+		while (page == nullptr || !page->AppendTuple(row, serialized_size, schema_)) {
+			if (page != nullptr) {
+				// the row does not even fit an empty page
+				bool empty_page = new_page && !page_dirty;
+				release_page();
+				if (empty_page) {
+					return rollback();
 				}
-			} else {
-				buffer_pool_manager_->UnpinPage(current_page->GetTablePageId(), false);
-				current_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
+			}
+			page_id_t page_id = free_space_map_.FindPage(serialized_size + TablePage::SIZE_TUPLE);
+			new_page = page_id == INVALID_PAGE_ID;
+			page_dirty = false;
+			page = new_page ? AppendPage(txn) : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+			if (page == nullptr) {
+				return rollback();
 			}
 		}
-		// Insert Tuple success
-		current_page_id_ = current_page->GetPageId();
-		buffer_pool_manager_->UnpinPage(current_page_id_, true); // is_dirty
-		flag = true;
+		page_dirty = true;
+		current_page_id_ = page->GetTablePageId();
+		inserted++;
 	}
- 
-	return flag;
+	if (page != nullptr) {
+		release_page();
+	}
+	return true;
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+	if (free_space_map_loaded_) {
+		return;
+	}
+	page_id_t page_id = first_page_id_;
+	while (page_id != INVALID_PAGE_ID) {
+		auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+		if (page == nullptr) {
+			LOG(ERROR) << "In TableHeap::LoadFreeSpaceMap page " << page_id << " not found";
+			return;
+		}
+		free_space_map_.Update(page_id, page->GetFreeSpaceRemaining());
+		last_page_id_ = page_id;
+		page_id = page->GetNextPageId();
+		buffer_pool_manager_->UnpinPage(last_page_id_, false);
+	}
+	free_space_map_loaded_ = true;
+}
+
+TablePage *TableHeap::AppendPage(Transaction *txn) {
+	auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+	if (last_page == nullptr) {
+		return nullptr;
+	}
+	page_id_t new_page_id;
+	auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id, last_page_id_));
+	if (new_page == nullptr) {
+		buffer_pool_manager_->UnpinPage(last_page_id_, false);
+		return nullptr;
+	}
+	new_page->Init(new_page_id, last_page_id_, log_manager_, txn);
+	last_page->SetNextPageId(new_page_id);
+	buffer_pool_manager_->UnpinPage(last_page_id_, true);
+	last_page_id_ = new_page_id;
+	return new_page;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
@@ -69,6 +155,7 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
 				page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
 			}		
 		}
+		free_space_map_.Update(page->GetTablePageId(), page->GetFreeSpaceRemaining());
 		buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 	}
 	return flag;
@@ -86,6 +173,7 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   	}
   // Step2: Delete the tuple from the page.
 	page->ApplyDelete(rid, txn, log_manager_);
+	free_space_map_.Update(page->GetTablePageId(), page->GetFreeSpaceRemaining());
 	buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 	return;
 }
@@ -114,6 +202,23 @@ bool TableHeap::GetTuple(Row *row, Transaction *txn) {
 	return flag;
 }
 
+bool TableHeap::GetTuples(page_id_t page_id, const std::vector<uint32_t> &slots, std::vector<Row> &rows,
+                          Transaction *txn, BufferRing *ring) {
+	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, ring));
+	if (page == nullptr) {
+		return false;
+	}
+	// 一次 pin 读完该页所有 slot
+	for (auto slot : slots) {
+		rows.emplace_back(RowId(page_id, slot));
+		if (!page->GetTuple(&rows.back(), schema_, txn, lock_manager_)) {
+			rows.pop_back();
+		}
+	}
+	buffer_pool_manager_->UnpinPage(page_id, false);
+	return true;
+}
+
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
@@ -129,19 +234,21 @@ void TableHeap::DeleteTable(page_id_t page_id) {
 /**
  * TODO: Student Implement
  */
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferRing *ring) {
 	auto page_id = first_page_id_;
 	RowId rid;
 	while (page_id != INVALID_PAGE_ID) {
-		auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+		auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, ring));
+		bool found = page->GetFirstTupleRid(&rid);
+		auto next_page_id = page->GetNextPageId();
 		buffer_pool_manager_->UnpinPage(page_id, false);
-		if (page->GetFirstTupleRid(&rid)) {
+		if (found) {
 			break;
 		}
-		page_id = page->GetNextPageId();
+		page_id = next_page_id;
 	}
 
-	return TableIterator(this, rid);
+	return TableIterator(this, rid, ring);
 }
 
 /**
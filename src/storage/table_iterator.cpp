@@ -1,14 +1,32 @@
 #include "storage/table_iterator.h"
 
+#include <stdexcept>
+
 #include "common/macros.h"
 #include "storage/table_heap.h"
 
+/** Follows the heap chain for read-ahead, called on a pinned and read-latched page. */
+static page_id_t NextTablePage(Page *page) {
+	return reinterpret_cast<TablePage *>(page)->GetNextPageId();
+}
+
 /**
  * TODO: Student Implement
  */
-TableIterator::TableIterator(TableHeap *table_heap, RowId rid) : table_heap_(table_heap), row_(new Row(rid)) {
-	if (row_->GetRowId().GetPageId() != INVALID_PAGE_ID) {
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, BufferRing *ring)
+    : table_heap_(table_heap), row_(new Row(rid)), ring_(ring) {
+	page_id_t page_id = row_->GetRowId().GetPageId();
+	if (page_id != INVALID_PAGE_ID) {
+		// bring the page in through the ring, GetTuple then hits it in the pool
+		auto buffer_pool_manager = table_heap_->buffer_pool_manager_;
+		auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id, ring_));
+		if (page != nullptr) {
+			buffer_pool_manager->PrefetchPage(page->GetNextPageId(), DEFAULT_PREFETCH_DEPTH, NextTablePage);
+		}
 		table_heap_->GetTuple(row_, nullptr);
+		if (page != nullptr) {
+			buffer_pool_manager->UnpinPage(page_id, false);
+		}
 	}
 	return;
 }
@@ -16,6 +34,7 @@ TableIterator::TableIterator(TableHeap *table_heap, RowId rid) : table_heap_(tab
 TableIterator::TableIterator(const TableIterator &other) {
 	table_heap_ = other.table_heap_;
 	row_ = new Row(*other.row_);
+	ring_ = other.ring_;
 }
 
 TableIterator::~TableIterator() {
@@ -42,6 +61,7 @@ Row *TableIterator::operator->() {
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
 	if (this != &itr) { // 避免自赋值
 		table_heap_ = itr.table_heap_;
+		ring_ = itr.ring_;
 		if (row_ != nullptr) {
 			delete row_;
 			row_ = NULL;
@@ -55,13 +75,21 @@ TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
 // ++iter
 TableIterator &TableIterator::operator++() {
 	auto buffer_pool_manager = table_heap_->buffer_pool_manager_;
-	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(row_->GetRowId().GetPageId()));
+	auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(row_->GetRowId().GetPageId(), ring_));
+	if (page == nullptr) {
+		throw std::runtime_error("out of memory");
+	}
 	RowId next_rid;
 	if (page->GetNextTupleRid(row_->GetRowId(), &next_rid) == false) {
 		while (page->GetNextPageId() != INVALID_PAGE_ID) {
-			auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page->GetNextPageId()));
+			auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page->GetNextPageId(), ring_));
 			buffer_pool_manager->UnpinPage(page->GetTablePageId(), false);
+			if (next_page == nullptr) {
+				throw std::runtime_error("out of memory");
+			}
 			page = next_page;
+			// stay a few pages ahead so the next boundary does not block on a read
+			buffer_pool_manager->PrefetchPage(page->GetNextPageId(), DEFAULT_PREFETCH_DEPTH, NextTablePage);
 			if (page->GetFirstTupleRid(&next_rid)) {
 				break;
 			}
@@ -1,8 +1,11 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -71,4 +74,202 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, MultiInstanceTest) {
+  const std::string db_name = "bpm_multi_instance_test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_instances = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+  ASSERT_EQ(num_instances, bpm->GetNumInstances());
+
+  // Scenario: fill every frame of every instance, each page records its own id.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id_temp);
+  }
+  // Scenario: the instance owning the next page id is full, so no new page can be created.
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+    // Scenario: unpinning a page twice is an error.
+    EXPECT_FALSE(bpm->UnpinPage(i, true));
+  }
+  // Scenario: new pages evict the unpinned ones, dirty victims are written back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  char expected[PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page-%zu", i);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+/**
+ * Fetch/unpin throughput of a memory-resident working set, with one shared pool and with a partitioned pool.
+ */
+TEST(BufferPoolManagerTest, ConcurrentFetchBenchmark) {
+  const std::string db_name = "bpm_concurrent_fetch_test.db";
+  const size_t buffer_pool_size = 1024;
+  const int ops_per_thread = 20000;
+
+  for (size_t num_instances : {1, 16}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+      bpm->UnpinPage(page_id_temp, true);
+    }
+    for (int num_threads : {1, 2, 4, 8, 16}) {
+      std::atomic<int> failed{0};
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          std::mt19937 rng(t);
+          std::uniform_int_distribution<page_id_t> dist(0, buffer_pool_size - 1);
+          for (int i = 0; i < ops_per_thread; i++) {
+            page_id_t page_id = dist(rng);
+            if (bpm->FetchPage(page_id) == nullptr || !bpm->UnpinPage(page_id, false)) {
+              failed++;
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      ASSERT_EQ(0, failed);
+      std::cout << "instances=" << num_instances << " threads=" << num_threads
+                << " fetch/s=" << static_cast<uint64_t>(num_threads * ops_per_thread / seconds) << std::endl;
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const std::string db_name = "bpm_test.db";
+  const size_t buffer_pool_size = 64;
+
+  // Dirty the whole pool, then replace every page. Returns the number of foreground writes the replacement caused.
+  auto run = [&](bool page_cleaner) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      Page *page = bpm->NewPage(page_id);
+      EXPECT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      page_ids.push_back(page_id);
+    }
+    if (page_cleaner) {
+      bpm->StartPageCleaner(1.0, 1);
+      for (int i = 0; i < 1000 && bpm->GetBackgroundWriteCount() < buffer_pool_size; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWriteCount());
+    }
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      EXPECT_NE(nullptr, bpm->NewPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    uint64_t foreground_writes = bpm->GetForegroundWriteCount();
+    // whoever wrote them, the evicted pages must read back intact
+    for (auto id : page_ids) {
+      Page *page = bpm->FetchPage(id);
+      EXPECT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(id, false));
+    }
+    delete bpm;
+    delete disk_manager;
+    remove(db_name.c_str());
+    return foreground_writes;
+  };
+
+  EXPECT_EQ(buffer_pool_size, run(false));
+  EXPECT_EQ(0, run(true));
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // every page stores the id of the page after it, like a heap or leaf chain
+  std::vector<page_id_t> page_ids(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_ids[i]));
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    Page *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    *reinterpret_cast<page_id_t *>(page->GetData()) = i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID;
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  auto wait_for_prefetch = [&](uint64_t count) {
+    for (int i = 0; i < 1000 && bpm->GetPrefetchReadCount() < count; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(count, bpm->GetPrefetchReadCount());
+  };
+  auto check_page = [&](size_t i) {
+    Page *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID, *reinterpret_cast<page_id_t *>(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  };
+
+  // Scenario: single pages. The first pages were evicted long ago and have to be read from disk.
+  for (size_t i = 0; i < 4; i++) {
+    bpm->PrefetchPage(page_ids[i]);
+  }
+  wait_for_prefetch(4);
+  for (size_t i = 0; i < 4; i++) {
+    check_page(i);
+  }
+
+  // Scenario: follow the chain for four pages, cached pages are skipped and do not count.
+  bpm->PrefetchPage(page_ids[8], 4, [](Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); });
+  wait_for_prefetch(8);
+  for (size_t i = 8; i < 12; i++) {
+    check_page(i);
+  }
+  bpm->PrefetchPage(page_ids[num_pages - 1]);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(8, bpm->GetPrefetchReadCount());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
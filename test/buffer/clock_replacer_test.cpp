@@ -0,0 +1,131 @@
+#include "buffer/clock_replacer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(CLOCKReplacerTest, SampleTest) {
+  CLOCKReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+  clock_replacer.Unpin(4);
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // Scenario: get three victims from the clock. The first sweep clears every reference bit.
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: unpin 4. Its reference bit is set again, so it gets a second chance.
+  clock_replacer.Unpin(4);
+
+  // Scenario: continue looking for victims. We expect these victims.
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(0, clock_replacer.Size());
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+}
+
+TEST(CLOCKReplacerTest, BufferPoolTest) {
+  const std::string db_name = "clock_replacer_test.db";
+  const size_t buffer_pool_size = 8;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, ReplacerType::kClock);
+
+  // Scenario: write four times more pages than the pool holds, every page is evicted at least once.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * 4; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  // Scenario: every page reads back what was written.
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  // Scenario: a fully pinned pool has no victim.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+/**
+ * Steady state of a full buffer pool: every miss evicts a frame and unpins it again once the new page is loaded, and
+ * every hit pins and unpins a resident frame.
+ */
+static double ReplacerNsPerOp(Replacer *replacer, size_t num_frames, size_t num_ops) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, static_cast<frame_id_t>(num_frames) - 1);
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer->Unpin(static_cast<frame_id_t>(i));
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    frame_id_t frame_id;
+    if (i % 2 == 0) {
+      EXPECT_TRUE(replacer->Victim(&frame_id));
+    } else {
+      frame_id = frame_dist(rng);
+      replacer->Pin(frame_id);
+    }
+    replacer->Unpin(frame_id);
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(num_frames, replacer->Size());
+  return std::chrono::duration<double, std::nano>(end - start).count() / num_ops;
+}
+
+TEST(CLOCKReplacerTest, VictimUnpinBenchmark) {
+  const size_t num_frames = DEFAULT_BUFFER_POOL_SIZE;
+  const size_t num_ops = 2000000;
+  std::unique_ptr<Replacer> lru(new LRUReplacer(num_frames));
+  std::unique_ptr<Replacer> clock(new CLOCKReplacer(num_frames));
+  std::cout << "frames=" << num_frames << " LRUReplacer ns/op=" << ReplacerNsPerOp(lru.get(), num_frames, num_ops)
+            << std::endl;
+  std::cout << "frames=" << num_frames << " CLOCKReplacer ns/op=" << ReplacerNsPerOp(clock.get(), num_frames, num_ops)
+            << std::endl;
+}
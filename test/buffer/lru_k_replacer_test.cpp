@@ -0,0 +1,118 @@
+#include "buffer/lru_k_replacer.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1-5 are referenced once, frame 6 twice.
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Pin(i);
+  }
+  lru_k_replacer.Pin(6);
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with less than k references go first, in order of their first reference.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: frame 3 is referenced again and now has a finite backward k-distance, 4 and 5 still go before it.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(3);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+
+  // Scenario: among frames with k references, the one with the oldest k-th most recent reference goes first.
+  // Frame 3 was first referenced before frame 6, so its backward 2-distance is larger.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: pinned frames are never victimized.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+/**
+ * A handful of index pages is looked up over and over while a full table scan streams through many more pages than the
+ * pool holds. Every cached copy of an index page carries an in-memory marker that is never written back, so the marker
+ * disappears exactly when the page was evicted and re-read.
+ * @return number of index pages that were evicted during the scan
+ */
+static size_t CountEvictedIndexPages(ReplacerType replacer_type) {
+  const std::string db_name = "lru_k_scan_test.db";
+  const size_t buffer_pool_size = 32;
+  const size_t index_pages = 8;
+  const size_t table_pages = 256;
+  const char marker[] = "hot index page";
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, replacer_type);
+
+  std::vector<page_id_t> index_page_ids, table_page_ids;
+  page_id_t page_id;
+  for (size_t i = 0; i < index_pages + table_pages; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    (i < index_pages ? index_page_ids : table_page_ids).push_back(page_id);
+  }
+
+  // index pages are probed a few times before the scan starts
+  for (int round = 0; round < 3; round++) {
+    for (auto id : index_page_ids) {
+      Page *page = bpm->FetchPage(id);
+      EXPECT_NE(nullptr, page);
+      memcpy(page->GetData(), marker, sizeof(marker));
+      EXPECT_TRUE(bpm->UnpinPage(id, false));
+    }
+  }
+
+  // full table scan, every table page is referenced exactly once
+  for (auto id : table_page_ids) {
+    EXPECT_NE(nullptr, bpm->FetchPage(id));
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  size_t evicted = 0;
+  for (auto id : index_page_ids) {
+    Page *page = bpm->FetchPage(id);
+    EXPECT_NE(nullptr, page);
+    if (memcmp(page->GetData(), marker, sizeof(marker)) != 0) {
+      evicted++;
+    }
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  return evicted;
+}
+
+TEST(LRUKReplacerTest, HotIndexPagesSurviveTableScanTest) {
+  // plain LRU flushes the whole pool during the scan
+  EXPECT_EQ(8, CountEvictedIndexPages(ReplacerType::kLRU));
+  // LRU-K only recycles the frames used by the scan
+  EXPECT_EQ(0, CountEvictedIndexPages(ReplacerType::kLRUK));
+}
@@ -39,6 +39,25 @@ TEST(CatalogTest, CatalogMetaTest) {
   delete other;
 }
 
+TEST(CatalogTest, IndexMetadataTest) {
+  char *buf = new char[PAGE_SIZE];
+  IndexMetadata *meta = IndexMetadata::Create(3, "idx-covering", 7, {2, 0}, "bptree", {1, 4, 5});
+  uint32_t size = meta->SerializeTo(buf);
+  ASSERT_EQ(meta->GetSerializedSize(), size);
+  IndexMetadata *other = nullptr;
+  ASSERT_EQ(size, IndexMetadata::DeserializeFrom(buf, other));
+  ASSERT_NE(nullptr, other);
+  EXPECT_EQ(meta->GetIndexId(), other->GetIndexId());
+  EXPECT_EQ(meta->GetIndexName(), other->GetIndexName());
+  EXPECT_EQ(meta->GetTableId(), other->GetTableId());
+  EXPECT_EQ(meta->GetKeyMapping(), other->GetKeyMapping());
+  EXPECT_EQ(meta->GetIndexType(), other->GetIndexType());
+  EXPECT_EQ(meta->GetIncludeMapping(), other->GetIncludeMapping());
+  delete meta;
+  delete other;
+  delete[] buf;
+}
+
 TEST(CatalogTest, CatalogTableTest) {
   /** Stage 2: Testing simple operation */
   auto db_01 = new DBStorageEngine(db_file_name, true);
@@ -1,12 +1,17 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include <algorithm>
+#include <set>
+
+#include "executor/executors/insert_executor.h"
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
+#include "planner/planner.h"
 
 // SELECT id FROM table-1 WHERE id < 500
 TEST_F(ExecutorTest, SimpleSeqScanTest) {
@@ -155,3 +160,187 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// INSERT INTO table-1 VALUES (7, "aaa", 1.5), (7, "bbb", 1.5); with a non-unique index on id
+TEST_F(TableTest, NonUniqueIndexInsertTest) {
+  IndexInfo *index_info = CreateIndex("index-id", {"id"});
+  ASSERT_FALSE(index_info->IsUnique());
+
+  // the key repeats within the batch and is in the index already
+  std::vector<Row> batch;
+  for (const char *name : {"aaa", "bbb"}) {
+    Fields fields{Field(kTypeInt, 7), Field(kTypeChar, const_cast<char *>(name), 3, false), Field(kTypeFloat, 1.5f)};
+    batch.emplace_back(fields);
+  }
+  InsertExecutor::InsertBatch(GetTableInfo(), GetIndexes(), batch, nullptr);
+  ASSERT_NE(INVALID_PAGE_ID, batch[0].GetRowId().GetPageId());
+  ASSERT_NE(INVALID_PAGE_ID, batch[1].GetRowId().GetPageId());
+
+  // the index has the old row and both new ones
+  Fields key_fields{Field(kTypeInt, 7)};
+  Row key(key_fields);
+  std::vector<RowId> rids;
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, rids, nullptr));
+  ASSERT_EQ(3, rids.size());
+  std::set<int64_t> expected{batch[0].GetRowId().Get(), batch[1].GetRowId().Get()};
+  ASSERT_EQ(1, std::count_if(rids.begin(), rids.end(), [&](RowId rid) { return expected.count(rid.Get()) == 0; }));
+}
+
+// the terms of nested ANDs, or ORs, in order; anything else is a single term
+TEST_F(TableTest, PlannerSplitLogicTest) {
+  const Schema *schema = GetTableInfo()->GetSchema();
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto id_1 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 1)), "=");
+  auto id_2 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 2)), "=");
+  auto id_3 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 3)), "=");
+  auto id_4 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 4)), "=");
+  // (id = 1 AND id = 2) AND (id = 3 OR id = 4)
+  auto either = MakeLogicExpression(id_3, id_4, LogicType::Or);
+  auto predicate = MakeLogicExpression(MakeLogicExpression(id_1, id_2, LogicType::And), either, LogicType::And);
+
+  std::vector<AbstractExpressionRef> terms;
+  Planner::SplitLogic(predicate, LogicType::And, terms);
+  ASSERT_EQ((std::vector<AbstractExpressionRef>{id_1, id_2, either}), terms);
+  terms.clear();
+  Planner::SplitLogic(predicate, LogicType::Or, terms);
+  ASSERT_EQ(std::vector<AbstractExpressionRef>{predicate}, terms);
+  terms.clear();
+  Planner::SplitLogic(either, LogicType::Or, terms);
+  ASSERT_EQ((std::vector<AbstractExpressionRef>{id_3, id_4}), terms);
+  terms.clear();
+  Planner::SplitLogic(id_1, LogicType::And, terms);
+  ASSERT_EQ(std::vector<AbstractExpressionRef>{id_1}, terms);
+}
+
+// SELECT id FROM table-1 WHERE id = 1 OR account = 2.5, with indexes on id and account
+TEST_F(TableTest, PlannerBitmapOrTest) {
+  const Schema *schema = GetTableInfo()->GetSchema();
+  IndexInfo *id_index = CreateIndex("index-id", {"id"});
+  IndexInfo *account_index = CreateIndex("index-account", {"account"});
+  std::vector<IndexInfo *> indexes{id_index, account_index};
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+  auto id_1 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 1)), "=");
+  auto account_2 = MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat, 2.5f)), "=");
+  auto name_x = MakeComparisonExpression(
+      col_name, MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("x"), 1, false)), "=");
+  auto out_schema = MakeOutputSchema({{"id", col_id}});
+
+  // both terms have an index: the union of their row ids answers the OR, nothing is left to check
+  auto predicate = MakeLogicExpression(id_1, account_2, LogicType::Or);
+  std::vector<bool> used(1, false);
+  auto condition = Planner::MatchBitmap(indexes, {predicate}, used);
+  ASSERT_NE(nullptr, condition);
+  ASSERT_EQ(nullptr, condition->index_);
+  ASSERT_EQ(LogicType::Or, condition->logic_type_);
+  ASSERT_EQ(2, condition->children_.size());
+  ASSERT_EQ(id_index, condition->children_[0]->index_);
+  ASSERT_EQ(account_index, condition->children_[1]->index_);
+  ASSERT_TRUE(used[0]);
+  auto plan = Planner::PlanScan("table-1", indexes, out_schema, predicate, false);
+  ASSERT_EQ(PlanType::BitmapHeapScan, plan->GetType());
+  ASSERT_EQ(nullptr, dynamic_pointer_cast<const BitmapHeapScanPlanNode>(plan)->GetPredicate());
+
+  // no index answers name = 'x', every row has to be read
+  predicate = MakeLogicExpression(id_1, name_x, LogicType::Or);
+  used.assign(1, false);
+  ASSERT_EQ(nullptr, Planner::MatchBitmap(indexes, {predicate}, used));
+  ASSERT_FALSE(used[0]);
+  plan = Planner::PlanScan("table-1", indexes, out_schema, predicate, false);
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+
+  // id = 1 OR (account = 2.5 AND name = 'x'): the union holds extra rows, the OR stays in the residual
+  predicate = MakeLogicExpression(id_1, MakeLogicExpression(account_2, name_x, LogicType::And), LogicType::Or);
+  used.assign(1, false);
+  condition = Planner::MatchBitmap(indexes, {predicate}, used);
+  ASSERT_NE(nullptr, condition);
+  ASSERT_EQ(LogicType::Or, condition->logic_type_);
+  ASSERT_EQ(2, condition->children_.size());
+  ASSERT_FALSE(used[0]);
+  plan = Planner::PlanScan("table-1", indexes, out_schema, predicate, false);
+  ASSERT_EQ(PlanType::BitmapHeapScan, plan->GetType());
+  ASSERT_EQ(predicate, dynamic_pointer_cast<const BitmapHeapScanPlanNode>(plan)->GetPredicate());
+}
+
+// WHERE id = 1 AND name > 'a' AND account = 2.5: a second index is ANDed in only for a whole key
+TEST_F(TableTest, PlannerBitmapAndTest) {
+  const Schema *schema = GetTableInfo()->GetSchema();
+  IndexInfo *id_name_index = CreateIndex("index-id-name", {"id", "name"});
+  IndexInfo *account_name_index = CreateIndex("index-account-name", {"account", "name"});
+  IndexInfo *account_index = CreateIndex("index-account", {"account"});
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto col_account = MakeColumnValueExpression(*schema, 0, "account");
+  std::vector<AbstractExpressionRef> conjuncts{
+      MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 1)), "="),
+      MakeComparisonExpression(col_name,
+                               MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("a"), 1, false)), ">"),
+      MakeComparisonExpression(col_account, MakeConstantValueExpression(Field(kTypeFloat, 2.5f)), "=")};
+
+  // account = 2.5 is only a prefix of (account, name), it is checked on the rows instead
+  std::vector<bool> used(conjuncts.size(), false);
+  auto condition = Planner::MatchBitmap({id_name_index, account_name_index}, conjuncts, used);
+  ASSERT_NE(nullptr, condition);
+  ASSERT_EQ(id_name_index, condition->index_);
+  ASSERT_EQ((std::vector<bool>{true, true, false}), used);
+
+  // it is the whole key of an index on account
+  used.assign(conjuncts.size(), false);
+  condition = Planner::MatchBitmap({id_name_index, account_name_index, account_index}, conjuncts, used);
+  ASSERT_NE(nullptr, condition);
+  ASSERT_EQ(nullptr, condition->index_);
+  ASSERT_EQ(LogicType::And, condition->logic_type_);
+  ASSERT_EQ(2, condition->children_.size());
+  ASSERT_EQ(id_name_index, condition->children_[0]->index_);
+  ASSERT_EQ(account_index, condition->children_[1]->index_);
+  ASSERT_EQ((std::vector<bool>{true, true, true}), used);
+}
+
+// the scan under DELETE/UPDATE ... WHERE id = 42 collects its row ids first; without an index to use it reads the table
+TEST_F(TableTest, PlannerModifyScanTest) {
+  const Schema *schema = GetTableInfo()->GetSchema();
+  IndexInfo *index_info = CreateIndex("index-id", {"id"});
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto id_42 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 42)), "=");
+  auto name_x = MakeComparisonExpression(
+      col_name, MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("x"), 1, false)), "=");
+
+  // a SELECT looks the key up in the index
+  auto plan = Planner::PlanScan("table-1", GetIndexes(), schema, id_42, false);
+  ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+
+  // a DELETE or UPDATE must not meet the rows it changed again through an open cursor
+  plan = Planner::PlanScan("table-1", GetIndexes(), schema, id_42, true);
+  ASSERT_EQ(PlanType::BitmapHeapScan, plan->GetType());
+  auto bitmap_plan = dynamic_pointer_cast<const BitmapHeapScanPlanNode>(plan);
+  ASSERT_EQ(index_info, bitmap_plan->condition_->index_);
+  ASSERT_EQ(std::vector<AbstractExpressionRef>{id_42->GetChildAt(1)}, bitmap_plan->condition_->key_range_.prefix_);
+  ASSERT_EQ(nullptr, bitmap_plan->GetPredicate());
+
+  plan = Planner::PlanScan("table-1", GetIndexes(), schema, name_x, true);
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+  plan = Planner::PlanScan("table-1", GetIndexes(), schema, nullptr, true);
+  ASSERT_EQ(PlanType::SeqScan, plan->GetType());
+}
+
+// SELECT * FROM table-1 WHERE id = 42, with a B+ tree and a hash index on id: the hash index answers the lookup
+TEST_F(TableTest, PlannerHashLookupTest) {
+  const Schema *schema = GetTableInfo()->GetSchema();
+  IndexInfo *tree_index = CreateIndex("index-id-tree", {"id"});
+  IndexInfo *hash_index = CreateIndex("index-id-hash", {"id"}, "hash");
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto id_42 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 42)), "=");
+  auto id_gt_42 = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, 42)), ">");
+
+  for (auto indexes : {std::vector<IndexInfo *>{tree_index, hash_index}, {hash_index, tree_index}}) {
+    auto plan = Planner::PlanScan("table-1", indexes, schema, id_42, false);
+    ASSERT_EQ(PlanType::IndexScan, plan->GetType());
+    ASSERT_EQ(hash_index, dynamic_pointer_cast<const IndexScanPlanNode>(plan)->indexes_[0]);
+    // a range is for the B+ tree only
+    plan = Planner::PlanScan("table-1", indexes, schema, id_gt_42, false);
+    ASSERT_EQ(PlanType::BitmapHeapScan, plan->GetType());
+    ASSERT_EQ(tree_index, dynamic_pointer_cast<const BitmapHeapScanPlanNode>(plan)->condition_->index_);
+  }
+}
@@ -21,61 +21,17 @@
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 #include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
 #include "utils/utils.h"
 
-/**
- * The ExecutorTest class defines a test fixture for executor tests.
- * Any test that is defined as part of the `ExecutorTest` fixture
- * will have access to the helper functions defined below.
- */
 using Fields = std::vector<Field>;
 
-class ExecutorTest : public ::testing::Test {
+/**
+ * The PlanTest class is the base of the test fixtures that build plans: it has the helper functions defined below to
+ * make expressions and output schemas, and owns the expressions it makes.
+ */
+class PlanTest : public ::testing::Test {
  public:
-  /** Called before every executor test. */
-  void SetUp() override {
-    ::testing::Test::SetUp();
-
-    // Initialize the database subsystems
-    db_test_ = new DBStorageEngine("executor_test.db", true);
-    auto &catalog_01 = db_test_->catalog_mgr_;
-    TableInfo *table_info = nullptr;
-    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
-                                     new Column("name", TypeId::kTypeChar, 64, 1, true, false),
-                                     new Column("account", TypeId::kTypeFloat, 2, true, false)};
-    auto schema = std::make_shared<Schema>(columns);
-    catalog_01->CreateTable("table-1", schema.get(), txn_, table_info);
-    TableHeap *table_heap = table_info->GetTableHeap();
-    for (int i = 0; i < 1000; i++) {
-      int32_t len = RandomUtils::RandomInt(0, 64);
-      char *characters = new char[len];
-      RandomUtils::RandomString(characters, len);
-      auto *fields =
-          new Fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
-                     Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
-      Row row(*fields);
-      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
-      delete[] characters;
-    }
-    // Create an executor context for our executors
-    exec_ctx_ = std::make_unique<ExecuteContext>(txn_, db_test_->catalog_mgr_, db_test_->bpm_);
-
-    // Construct the executor engine for the test
-    execution_engine_ = std::make_unique<ExecuteEngine>();
-  }
-
-  /** Called after every executor test. */
-  void TearDown() override { delete db_test_; };
-
-  /** @return The executor context for our test instance. */
-  ExecuteContext *GetExecutorContext() { return exec_ctx_.get(); }
-
-  /** @return The execution engine for our test instance. */
-  ExecuteEngine *GetExecutionEngine() { return execution_engine_.get(); }
-
-  /** @return Get the transaction for our test instance. */
-  Transaction *GetTxn() { return txn_; }
-
   /**
    * Make a column value expression.
    * @param schema The schema for the expression
@@ -149,6 +105,19 @@ class ExecutorTest : public ::testing::Test {
                                                      string comp_type) {
     return std::make_shared<ComparisonExpression>(lhs, rhs, comp_type);
   }
+  /**
+   * Make a logic expression.
+   * @param lhs The abstract expression for the left-hand side of the AND or OR
+   * @param rhs The abstract expression for the right-hand side of the AND or OR
+   * @param logic_type The type of the logic operation
+   * @return A non-owning pointer to the LogicExpression
+   */
+  AbstractExpressionRef MakeLogicExpression(AbstractExpressionRef lhs, AbstractExpressionRef rhs,
+                                            LogicType logic_type) {
+    allocated_exprs_.emplace_back(std::make_shared<LogicExpression>(lhs, rhs, logic_type));
+    return allocated_exprs_.back();
+  }
+
   /**
    * Make an output schema.
    * @param exprs The expressions that define the columns of the output schema
@@ -169,6 +138,65 @@ class ExecutorTest : public ::testing::Test {
     return new Schema(cols);
   }
 
+ private:
+  /** The collection of allocated expressions, owned by the fixture */
+  std::vector<AbstractExpressionRef> allocated_exprs_;
+
+  /** The maximum size allowed for VARCHAR columns */
+  static constexpr const uint32_t MAX_VARCHAR_SIZE = 128;
+};
+
+/**
+ * The ExecutorTest class defines a test fixture for executor tests.
+ * Any test that is defined as part of the `ExecutorTest` fixture
+ * will have access to the helper functions of PlanTest and defined below.
+ */
+class ExecutorTest : public PlanTest {
+ public:
+  /** Called before every executor test. */
+  void SetUp() override {
+    PlanTest::SetUp();
+
+    // Initialize the database subsystems
+    db_test_ = new DBStorageEngine("executor_test.db", true);
+    auto &catalog_01 = db_test_->catalog_mgr_;
+    TableInfo *table_info = nullptr;
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                     new Column("account", TypeId::kTypeFloat, 2, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    catalog_01->CreateTable("table-1", schema.get(), txn_, table_info);
+    TableHeap *table_heap = table_info->GetTableHeap();
+    for (int i = 0; i < 1000; i++) {
+      int32_t len = RandomUtils::RandomInt(0, 64);
+      char *characters = new char[len];
+      RandomUtils::RandomString(characters, len);
+      auto *fields =
+          new Fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
+                     Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
+      Row row(*fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      delete[] characters;
+    }
+    // Create an executor context for our executors
+    exec_ctx_ = std::make_unique<ExecuteContext>(txn_, db_test_->catalog_mgr_, db_test_->bpm_);
+
+    // Construct the executor engine for the test
+    execution_engine_ = std::make_unique<ExecuteEngine>();
+  }
+
+  /** Called after every executor test. */
+  void TearDown() override { delete db_test_; };
+
+  /** @return The executor context for our test instance. */
+  ExecuteContext *GetExecutorContext() { return exec_ctx_.get(); }
+
+  /** @return The execution engine for our test instance. */
+  ExecuteEngine *GetExecutionEngine() { return execution_engine_.get(); }
+
+  /** @return Get the transaction for our test instance. */
+  Transaction *GetTxn() { return txn_; }
+
  private:
   /** The transaction context for the test */
   Transaction *txn_{nullptr};
@@ -178,11 +206,100 @@ class ExecutorTest : public ::testing::Test {
   std::unique_ptr<ExecuteContext> exec_ctx_;
   /** The execution engine */
   std::unique_ptr<ExecuteEngine> execution_engine_;
-  /** The collection of allocated expressions, owned by the fixture */
-  std::vector<AbstractExpressionRef> allocated_exprs_;
+};
 
-  /** The maximum size allowed for VARCHAR columns */
-  static constexpr const uint32_t MAX_VARCHAR_SIZE = 128;
+/**
+ * The TableTest class defines a test fixture with the table of ExecutorTest built directly over a TableHeap, and
+ * indexes on it built directly as IndexInfo, without the catalog. Its tests plan with Planner::PlanScan over the
+ * indexes they create, and execute only what needs no catalog.
+ */
+class TableTest : public PlanTest {
+ public:
+  /** Called before every table test. */
+  void SetUp() override {
+    PlanTest::SetUp();
+
+    remove(db_file_name_.c_str());
+    disk_mgr_ = new DiskManager(db_file_name_);
+    bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+    // the pages DBStorageEngine allocates first, the indexes keep their roots in the second one
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm_->NewPage(page_id));
+    ASSERT_NE(nullptr, bpm_->NewPage(page_id));
+    ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+    bpm_->UnpinPage(CATALOG_META_PAGE_ID, false);
+    bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                     new Column("account", TypeId::kTypeFloat, 2, true, false)};
+    auto *schema = new Schema(columns);
+    TableHeap *table_heap = TableHeap::Create(bpm_, schema, nullptr, nullptr, nullptr);
+    table_info_ = TableInfo::Create();
+    table_info_->Init(TableMetadata::Create(0, "table-1", table_heap->GetFirstPageId(), schema), table_heap);
+    for (int i = 0; i < 1000; i++) {
+      int32_t len = RandomUtils::RandomInt(0, 64);
+      char *characters = new char[len];
+      RandomUtils::RandomString(characters, len);
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
+                    Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      delete[] characters;
+    }
+  }
+
+  /** Called after every table test. */
+  void TearDown() override {
+    for (auto index_info : indexes_) {
+      delete index_info;
+    }
+    delete table_info_;
+    delete bpm_;
+    delete disk_mgr_;
+    remove(db_file_name_.c_str());
+  }
+
+  /** @return The table of the test, named "table-1" with columns id, name and account. */
+  TableInfo *GetTableInfo() { return table_info_; }
+
+  /** @return The indexes created on the table, in order. */
+  const std::vector<IndexInfo *> &GetIndexes() { return indexes_; }
+
+  /**
+   * Create an index on the table and fill it with the rows in the table, like CREATE INDEX.
+   * @param index_name The name of the index
+   * @param index_keys The names of its key columns
+   * @param index_type "bptree" or "hash"
+   * @return The index, owned by the fixture
+   */
+  IndexInfo *CreateIndex(const std::string &index_name, const std::vector<std::string> &index_keys,
+                         const std::string &index_type = "bptree") {
+    Schema *schema = table_info_->GetSchema();
+    std::vector<uint32_t> key_map;
+    for (auto &key : index_keys) {
+      uint32_t col_idx;
+      schema->GetColumnIndex(key, col_idx);
+      key_map.push_back(col_idx);
+    }
+    auto *index_info = IndexInfo::Create();
+    index_info->Init(IndexMetadata::Create(indexes_.size(), index_name, table_info_->GetTableId(), key_map, index_type),
+                     table_info_, bpm_);
+    indexes_.push_back(index_info);
+    TableHeap *table_heap = table_info_->GetTableHeap();
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+      Row key;
+      iter->GetKeyFromRow(schema, index_info->GetIndexKeySchema(), key);
+      index_info->GetIndex()->InsertEntry(key, iter->GetRowId(), nullptr);
+    }
+    return index_info;
+  }
+
+ private:
+  const std::string db_file_name_ = "table_test.db";
+  DiskManager *disk_mgr_{nullptr};
+  BufferPoolManager *bpm_{nullptr};
+  TableInfo *table_info_{nullptr};
+  std::vector<IndexInfo *> indexes_;
 };
 
 #endif  // MINISQL_EXECUTOR_TEST_UTIL_H
@@ -1,10 +1,13 @@
 #include "index/b_plus_tree_index.h"
 
+#include <atomic>
 #include <string>
+#include <thread>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/generic_key.h"
+#include "utils/utils.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -66,4 +69,479 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     i++;
   }
   delete index;
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, GenericKeyOrderTest) {
+  // keys compare like their fields (nulls first), and deserialize back to the same fields
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 8, 2, true, false)};
+  Schema key_schema(columns);
+  KeyManager KP(&key_schema, 64);
+  std::vector<int32_t> ints{INT32_MIN, -70000, -1, 0, 1, 255, 256, 70000, INT32_MAX};
+  std::vector<float> floats{-1e30f, -2.5f, -1.0f, -0.0f, 0.0f, 1e-30f, 1.0f, 2.5f, 1e30f};
+  std::vector<std::string> strings{"", std::string("\0", 1), std::string("a\0", 2), "a", "ab", "abc", "b", "\xff"};
+  std::vector<std::vector<Field>> rows;
+  for (size_t i = 0; i < 300; i++) {
+    std::string &str = strings[RandomUtils::RandomInt(0, strings.size() - 1)];
+    rows.push_back({i % 17 == 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, ints[i % ints.size()]),
+                    i % 13 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, floats[i % floats.size()]),
+                    Field(TypeId::kTypeChar, const_cast<char *>(str.data()), str.size(), true)});
+  }
+  auto compare_fields = [](std::vector<Field> &lhs, std::vector<Field> &rhs) {
+    for (size_t i = 0; i < lhs.size(); i++) {
+      if (lhs[i].IsNull() || rhs[i].IsNull()) {
+        if (lhs[i].IsNull() != rhs[i].IsNull()) {
+          return lhs[i].IsNull() ? -1 : 1;
+        }
+        continue;
+      }
+      if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::kTrue) {
+        return -1;
+      }
+      if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::kTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  };
+  GenericKey *k1 = KP.InitKey();
+  GenericKey *k2 = KP.InitKey();
+  for (auto &lhs : rows) {
+    KP.SerializeFromKey(k1, Row(lhs), &key_schema);
+    for (auto &rhs : rows) {
+      KP.SerializeFromKey(k2, Row(rhs), &key_schema);
+      ASSERT_EQ(compare_fields(lhs, rhs), KP.CompareKeys(k1, k2));
+    }
+    Row key;
+    KP.DeserializeToKey(k1, key, &key_schema);
+    ASSERT_EQ(lhs.size(), key.GetFieldCount());
+    for (size_t i = 0; i < lhs.size(); i++) {
+      ASSERT_EQ(lhs[i].IsNull(), key.GetField(i)->IsNull());
+      if (!lhs[i].IsNull()) {
+        ASSERT_EQ(CmpBool::kTrue, lhs[i].CompareEquals(*key.GetField(i)));
+      }
+    }
+  }
+  free(k1);
+  free(k2);
+}
+
+TEST(BPlusTreeTests, GenericKeySizeTest) {
+  ASSERT_EQ(8, KeyManager::FitKeySize(5));
+  ASSERT_EQ(16, KeyManager::FitKeySize(9));
+  ASSERT_EQ(256, KeyManager::FitKeySize(256));
+  ASSERT_EQ(300, KeyManager::FitKeySize(300));
+  // the specialized compares and the memcmp fallback order keys alike
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  for (size_t key_size : {8, 24, 64}) {
+    KeyManager KP(&key_schema, key_size);
+    GenericKey *k1 = KP.InitKey();
+    GenericKey *k2 = KP.InitKey();
+    for (int i = 0; i < 1000; i++) {
+      int32_t l = RandomUtils::RandomInt(-1000, 1000) * 100000;
+      int32_t r = i % 10 == 0 ? l : RandomUtils::RandomInt(-1000, 1000) * 100000;
+      std::vector<Field> lhs{Field(TypeId::kTypeInt, l)};
+      std::vector<Field> rhs{Field(TypeId::kTypeInt, r)};
+      KP.SerializeFromKey(k1, Row(lhs), &key_schema);
+      KP.SerializeFromKey(k2, Row(rhs), &key_schema);
+      ASSERT_EQ((l > r) - (l < r), KP.CompareKeys(k1, k2));
+    }
+    free(k1);
+    free(k2);
+  }
+}
+
+TEST(BPlusTreeTests, GenericKeyMaxSizeTest) {
+  // 3 x char(8) is 24 bytes of raw data, but up to 3 x (1 + 8 x 2 + 2) = 57 bytes encoded
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeChar, 8, 0, true, false),
+                                   new Column("b", TypeId::kTypeChar, 8, 1, true, false),
+                                   new Column("c", TypeId::kTypeChar, 8, 2, true, false)};
+  Schema key_schema(columns);
+  size_t max_size = KeyManager::GetMaxKeySize(&key_schema);
+  ASSERT_EQ(57, max_size);
+  ASSERT_EQ(64, KeyManager::FitKeySize(max_size));
+  std::vector<Column *> int_columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                       new Column("account", TypeId::kTypeFloat, 1, true, false)};
+  Schema int_key_schema(int_columns);
+  ASSERT_EQ(10, KeyManager::GetMaxKeySize(&int_key_schema));
+  // the worst case keys fit and read back unchanged
+  KeyManager KP(&key_schema, KeyManager::FitKeySize(max_size));
+  GenericKey *k1 = KP.InitKey();
+  GenericKey *k2 = KP.InitKey();
+  std::string zeros(8, '\0');
+  std::string full(8, 'x');
+  std::vector<Field> lhs{Field(TypeId::kTypeChar, const_cast<char *>(zeros.data()), 8, true),
+                         Field(TypeId::kTypeChar, const_cast<char *>(zeros.data()), 8, true),
+                         Field(TypeId::kTypeChar, const_cast<char *>(zeros.data()), 8, true)};
+  std::vector<Field> rhs{Field(TypeId::kTypeChar, const_cast<char *>(zeros.data()), 8, true),
+                         Field(TypeId::kTypeChar, const_cast<char *>(zeros.data()), 8, true),
+                         Field(TypeId::kTypeChar, const_cast<char *>(full.data()), 8, true)};
+  KP.SerializeFromKey(k1, Row(lhs), &key_schema);
+  KP.SerializeFromKey(k2, Row(rhs), &key_schema);
+  ASSERT_EQ(-1, KP.CompareKeys(k1, k2));
+  Row key;
+  KP.DeserializeToKey(k1, key, &key_schema);
+  for (uint32_t i = 0; i < 3; i++) {
+    ASSERT_EQ(CmpBool::kTrue, lhs[i].CompareEquals(*key.GetField(i)));
+  }
+  free(k1);
+  free(k2);
+}
+
+TEST(BPlusTreeTests, ScanPrefixTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+  bpm->UnpinPage(CATALOG_META_PAGE_ID, false);
+  bpm->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false),
+                                   new Column("b", TypeId::kTypeInt, 1, true, false)};
+  Schema key_schema(columns);
+  auto *index = new BPlusTreeIndex(0, &key_schema, 16, bpm, false);
+  // two rows for every (a, b), and a few rows where b is null
+  struct Entry {
+    int a;
+    int b;  // INT32_MIN for null
+    RowId rid;
+  };
+  std::vector<Entry> entries;
+  for (int a = 0; a < 20; a++) {
+    for (int b = -50; b < 50; b++) {
+      for (int copy = 0; copy < 2; copy++) {
+        entries.push_back({a, b, RowId(a * 1000 + b + 50, copy)});
+      }
+    }
+    entries.push_back({a, INT32_MIN, RowId(a * 1000 + 999, 0)});
+  }
+  ShuffleArray(entries);
+  for (auto &entry : entries) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, entry.a), entry.b == INT32_MIN
+                                                                     ? Field(TypeId::kTypeInt)
+                                                                     : Field(TypeId::kTypeInt, entry.b)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), entry.rid, nullptr));
+  }
+
+  // every scan returns exactly the rows a filter over all rows finds
+  auto check = [&](std::vector<int> prefix, const int *lower, bool lower_inclusive, const int *upper,
+                   bool upper_inclusive) {
+    std::vector<Field> prefix_fields;
+    for (int value : prefix) {
+      prefix_fields.emplace_back(TypeId::kTypeInt, value);
+    }
+    std::unique_ptr<Field> lower_field, upper_field;
+    if (lower != nullptr) {
+      lower_field = std::make_unique<Field>(TypeId::kTypeInt, *lower);
+    }
+    if (upper != nullptr) {
+      upper_field = std::make_unique<Field>(TypeId::kTypeInt, *upper);
+    }
+    std::vector<RowId> result;
+    index->ScanPrefix(prefix_fields, lower_field.get(), lower_inclusive, upper_field.get(), upper_inclusive, result,
+                      nullptr);
+    std::vector<int64_t> expected;
+    for (auto &entry : entries) {
+      int values[] = {entry.a, entry.b};
+      bool match = true;
+      for (size_t i = 0; i < prefix.size(); i++) {
+        match = match && values[i] == prefix[i] && values[i] != INT32_MIN;
+      }
+      int next = values[prefix.size()];
+      if (lower != nullptr || upper != nullptr) {
+        match = match && next != INT32_MIN;
+      }
+      if (lower != nullptr) {
+        match = match && (lower_inclusive ? next >= *lower : next > *lower);
+      }
+      if (upper != nullptr) {
+        match = match && (upper_inclusive ? next <= *upper : next < *upper);
+      }
+      if (match) {
+        expected.push_back(entry.rid.Get());
+      }
+    }
+    std::vector<int64_t> actual;
+    for (auto &rid : result) {
+      actual.push_back(rid.Get());
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(expected, actual);
+  };
+  int minus_three = -3;
+  int zero = 0;
+  int five = 5;
+  int ten = 10;
+  int two = 2;
+  int eighteen = 18;
+  int big = 100;
+  check({7}, nullptr, false, nullptr, false);
+  check({7, 12}, nullptr, false, nullptr, false);
+  check({7, 120}, nullptr, false, nullptr, false);
+  check({7}, &ten, false, nullptr, false);
+  check({7}, &ten, true, nullptr, false);
+  check({7}, nullptr, false, &minus_three, false);
+  check({7}, nullptr, false, &minus_three, true);
+  check({7}, &zero, false, &five, true);
+  check({19}, &big, false, nullptr, false);
+  check({}, &eighteen, true, nullptr, false);
+  check({}, nullptr, false, &two, false);
+  check({}, &two, false, &five, false);
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(BPlusTreeTests, IndexCursorTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+  bpm->UnpinPage(CATALOG_META_PAGE_ID, false);
+  bpm->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  auto *index = new BPlusTreeIndex(0, &key_schema, 8, bpm);
+  static const int n = 20000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(key, 0), nullptr));
+  }
+  auto drain = [](IndexCursor *cursor) {
+    std::vector<int> result;
+    RowId rid;
+    while (cursor->Next(rid)) {
+      result.push_back(rid.GetPageId());
+    }
+    return result;
+  };
+  auto range = [](int from, int to) {
+    std::vector<int> result;
+    for (int i = std::max(from, 0); i < std::min(to, n); i++) {
+      result.push_back(i);
+    }
+    return result;
+  };
+
+  // two sided bounds, in key order
+  Field five(TypeId::kTypeInt, 5), ten(TypeId::kTypeInt, 10), big(TypeId::kTypeInt, 15000);
+  ASSERT_EQ(range(6, 10), drain(index->OpenCursor({}, &five, false, &ten, false, nullptr).get()));
+  ASSERT_EQ(range(5, 11), drain(index->OpenCursor({}, &five, true, &ten, true, nullptr).get()));
+  ASSERT_EQ(range(5, 15000), drain(index->OpenCursor({}, &five, true, &big, false, nullptr).get()));
+  ASSERT_EQ(range(0, 11), drain(index->OpenCursor({}, nullptr, false, &ten, true, nullptr).get()));
+  ASSERT_EQ(range(15001, n), drain(index->OpenCursor({}, &big, false, nullptr, false, nullptr).get()));
+  ASSERT_TRUE(drain(index->OpenCursor({}, &ten, false, &five, false, nullptr).get()).empty());
+
+  // compare operators of ScanKey
+  std::vector<std::pair<std::string, std::vector<int>>> ops{{"=", range(15000, 15001)},
+                                                            {">", range(15001, n)},
+                                                            {">=", range(15000, n)},
+                                                            {"<", range(0, 15000)},
+                                                            {"<=", range(0, 15001)}};
+  std::vector<int> not_equal = range(0, n);
+  not_equal.erase(not_equal.begin() + 15000);
+  ops.emplace_back("<>", not_equal);
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 15000)};
+  for (auto &op : ops) {
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(key_fields), result, nullptr, op.first));
+    std::vector<int> actual;
+    for (auto &rid : result) {
+      actual.push_back(rid.GetPageId());
+    }
+    ASSERT_EQ(op.second, actual) << op.first;
+  }
+
+  // the cursor holds no latch between leaves: the tree can change under an open cursor, the keys it still has to
+  // reach that stay in the tree are returned once each, in order
+  auto cursor = index->OpenCursor({}, nullptr, false, nullptr, false, nullptr);
+  RowId rid;
+  std::vector<int> seen;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(cursor->Next(rid));
+    seen.push_back(rid.GetPageId());
+  }
+  for (int i = 1000; i < n; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  while (cursor->Next(rid)) {
+    seen.push_back(rid.GetPageId());
+  }
+  ASSERT_TRUE(std::is_sorted(seen.begin(), seen.end()));
+  ASSERT_EQ(seen.end(), std::adjacent_find(seen.begin(), seen.end()));
+  for (int i = 1000; i < n; i++) {
+    ASSERT_EQ(i % 2 == 1, std::binary_search(seen.begin(), seen.end(), i)) << i;
+  }
+  cursor.reset();
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(BPlusTreeTests, CoveringIndexTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+  bpm->UnpinPage(CATALOG_META_PAGE_ID, false);
+  bpm->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  // key column a, included column b
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, true),
+                                   new Column("b", TypeId::kTypeInt, 1, true, false)};
+  Schema key_schema(columns);
+  const int n = 5000;
+  for (bool unique : {true, false}) {
+    auto *index = new BPlusTreeIndex(unique ? 0 : 1, &key_schema, 16, bpm, unique, 1);
+    ASSERT_EQ(1, index->GetKeyColumnCount());
+    std::vector<std::pair<int, int>> rows;
+    for (int a = 0; a < n; a++) {
+      rows.emplace_back(a, (n - a) * 10);
+      if (!unique && a % 3 == 0) {
+        rows.emplace_back(a, a % 2 == 0 ? INT32_MIN : -a);
+      }
+    }
+    ShuffleArray(rows);
+    for (size_t i = 0; i < rows.size(); i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, rows[i].first), rows[i].second == INT32_MIN
+                                                                             ? Field(TypeId::kTypeInt)
+                                                                             : Field(TypeId::kTypeInt, rows[i].second)};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(rows[i].first, i), nullptr));
+    }
+    // the included column does not take part in uniqueness
+    std::vector<Field> other{Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeInt, 1)};
+    ASSERT_EQ(unique ? DB_FAILED : DB_SUCCESS, index->InsertEntry(Row(other), RowId(7, 999999), nullptr));
+    if (!unique) {
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(other), RowId(7, 999999), nullptr));
+    }
+
+    // ScanKey compares the key columns only, whatever the included columns of the probe
+    std::vector<Field> probe{Field(TypeId::kTypeInt, 3000), Field(TypeId::kTypeInt, 12345)};
+    for (std::string op : {"=", ">", ">=", "<", "<=", "<>"}) {
+      std::vector<RowId> result;
+      index->ScanKey(Row(probe), result, nullptr, op);
+      auto match = [&op](int a) {
+        int cmp = (a > 3000) - (a < 3000);
+        if (op == "=") return cmp == 0;
+        if (op == ">") return cmp > 0;
+        if (op == ">=") return cmp >= 0;
+        if (op == "<") return cmp < 0;
+        if (op == "<=") return cmp <= 0;
+        return cmp != 0;
+      };
+      size_t expected = std::count_if(rows.begin(), rows.end(),
+                                      [&match](const std::pair<int, int> &row) { return match(row.first); });
+      ASSERT_EQ(expected, result.size()) << op;
+      for (auto &rid : result) {
+        ASSERT_TRUE(match(rid.GetPageId())) << op;
+      }
+    }
+
+    // a cursor with keys returns the stored columns of every entry, without the table
+    Field lower(TypeId::kTypeInt, 100);
+    Field upper(TypeId::kTypeInt, 200);
+    auto cursor = index->OpenCursor({}, &lower, true, &upper, false, nullptr, true);
+    RowId rid;
+    Row key;
+    size_t count = 0;
+    while (cursor->Next(rid, key)) {
+      auto &row = rows[rid.GetSlotNum()];
+      ASSERT_EQ(CmpBool::kTrue, key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, row.first)));
+      if (row.second == INT32_MIN) {
+        ASSERT_TRUE(key.GetField(1)->IsNull());
+      } else {
+        ASSERT_EQ(CmpBool::kTrue, key.GetField(1)->CompareEquals(Field(TypeId::kTypeInt, row.second)));
+      }
+      count++;
+    }
+    ASSERT_EQ(std::count_if(rows.begin(), rows.end(),
+                            [](const std::pair<int, int> &row) { return row.first >= 100 && row.first < 200; }),
+              count);
+    delete index;
+  }
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(BPlusTreeTests, CoveringUniqueTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+  bpm->UnpinPage(CATALOG_META_PAGE_ID, false);
+  bpm->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  // unique key column name, included column b
+  std::vector<Column *> columns = {new Column("name", TypeId::kTypeChar, 8, 0, false, true),
+                                   new Column("b", TypeId::kTypeInt, 1, true, false)};
+  Schema key_schema(columns);
+  auto *index = new BPlusTreeIndex(0, &key_schema, 32, bpm, true, 1);
+  // b == INT32_MIN makes it null
+  auto make_row = [](int a, int b) {
+    std::string name = std::to_string(a);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                              b == INT32_MIN ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, b)};
+    return Row(fields);
+  };
+  // every thread inserts every name with its own included value, one of them wins each name
+  const int n = 3000;
+  const int num_threads = 4;
+  std::vector<std::atomic<int>> winners(n);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int a = 0; a < n; a++) {
+        int name = t % 2 == 0 ? a : n - 1 - a;
+        if (index->InsertEntry(make_row(name, t * 1000), RowId(name, t), nullptr) ==
+            DB_SUCCESS) {
+          winners[name]++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int a = 0; a < n; a++) {
+    ASSERT_EQ(1, winners[a].load()) << a;
+  }
+  // the included value sorts before or after the stored one, even when the stored entry starts a leaf
+  for (int a = 0; a < n; a++) {
+    ASSERT_EQ(DB_FAILED, index->InsertEntry(make_row(a, INT32_MIN), RowId(a, 100), nullptr));
+    ASSERT_EQ(DB_FAILED, index->InsertEntry(make_row(a, INT32_MAX), RowId(a, 100), nullptr));
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_row(a, 0), result, nullptr));
+    ASSERT_EQ(1, result.size());
+  }
+  // after a remove the name is free again
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_row(42, 0), result, nullptr));
+  int winner = static_cast<int>(result[0].GetSlotNum());
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_row(42, winner * 1000), result[0], nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_row(42, INT32_MIN), RowId(42, 100), nullptr));
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -1,5 +1,10 @@
 #include "index/b_plus_tree.h"
 
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
@@ -69,4 +74,398 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+
+/** Tree pages reachable from the leftmost leaf, i.e. the number of leaves. */
+static int CountLeaves(BPlusTree &tree, BufferPoolManager *bpm) {
+  int leaves = 0;
+  Page *page = tree.FindLeafPage(nullptr, INVALID_PAGE_ID, true);
+  while (page != nullptr) {
+    leaves++;
+    page_id_t next_page_id = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData())->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+  }
+  return leaves;
+}
+
+/** The catalog is not needed by the tree, allocate the pages before the index roots page by hand. */
+static void AllocateIndexRootsPage(BufferPoolManager *bpm) {
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(CATALOG_META_PAGE_ID, page_id);
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+  bpm->UnpinPage(CATALOG_META_PAGE_ID, false);
+  bpm->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  AllocateIndexRootsPage(bpm);
+
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  const int n = 20000;
+  std::vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  GenericKey *key = KP.InitKey();
+  auto make_key = [&](int i) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    return key;
+  };
+
+  // build one tree by inserting every key, one by bulk loading them through a sorter that has to spill runs
+  BPlusTree inserted(0, bpm, KP);
+  auto start = std::chrono::steady_clock::now();
+  for (int i : order) {
+    ASSERT_TRUE(inserted.Insert(make_key(i), RowId(i, i)));
+  }
+  auto insert_time = std::chrono::steady_clock::now() - start;
+  BPlusTree loaded(1, bpm, KP);
+  start = std::chrono::steady_clock::now();
+  KeySorter sorter(KP, 64 * 1024);
+  for (int i : order) {
+    sorter.Add(make_key(i), RowId(i, i));
+  }
+  sorter.Finish();
+  ASSERT_LT(1, sorter.GetRunCount());
+  ASSERT_TRUE(loaded.BulkLoad(sorter));
+  auto load_time = std::chrono::steady_clock::now() - start;
+  ASSERT_TRUE(loaded.Check());
+  int inserted_leaves = CountLeaves(inserted, bpm);
+  int loaded_leaves = CountLeaves(loaded, bpm);
+  std::cout << "insert: " << std::chrono::duration_cast<std::chrono::milliseconds>(insert_time).count() << " ms, "
+            << inserted_leaves << " leaves; bulk load: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(load_time).count() << " ms, " << loaded_leaves
+            << " leaves" << std::endl;
+  ASSERT_LT(loaded_leaves, inserted_leaves);
+
+  // every key is found, and the leaf chain returns them in order
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> result;
+    ASSERT_TRUE(loaded.GetValue(make_key(i), result));
+    ASSERT_EQ(RowId(i, i).Get(), result[0].Get());
+  }
+  int expected = 0;
+  for (auto iter = loaded.Begin(); iter != loaded.End(); ++iter) {
+    ASSERT_EQ(RowId(expected, expected).Get(), (*iter).second.Get());
+    expected++;
+  }
+  ASSERT_EQ(n, expected);
+  ASSERT_TRUE(loaded.Check());
+
+  // the loaded tree keeps working with regular inserts and removes
+  for (int i = n; i < n + 2000; i++) {
+    ASSERT_TRUE(loaded.Insert(make_key(i), RowId(i, i)));
+  }
+  for (int i = 0; i < n; i += 2) {
+    loaded.Remove(make_key(i));
+  }
+  for (int i = 0; i < n + 2000; i++) {
+    std::vector<RowId> result;
+    ASSERT_EQ(i >= n || i % 2 == 1, loaded.GetValue(make_key(i), result));
+  }
+  ASSERT_TRUE(loaded.Check());
+
+  // a duplicate key fails the load and leaves the tree empty
+  BPlusTree duplicated(2, bpm, KP);
+  KeySorter duplicates(KP);
+  for (int i = 0; i < 1000; i++) {
+    duplicates.Add(make_key(i % 999), RowId(i, i));
+  }
+  duplicates.Finish();
+  ASSERT_FALSE(duplicated.BulkLoad(duplicates));
+  ASSERT_TRUE(duplicated.IsEmpty());
+  ASSERT_TRUE(duplicated.Check());
+
+  free(key);
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(BPlusTreeTests, NonUniqueTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 8);
+  GenericKey *key = KP.InitKey();
+  auto make_key = [&](int i) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    return key;
+  };
+  // most keys have a few rows, inline in the leaf; every 50th key has rows for several posting pages
+  const int n = 1000;
+  std::vector<std::vector<RowId>> rows(n);
+  std::vector<std::pair<int, RowId>> pairs;
+  for (int i = 0; i < n; i++) {
+    int count = i % 50 == 0 ? 3 * PostingPage::MAX_SIZE : i % 7 + 1;
+    for (int j = 0; j < count; j++) {
+      rows[i].emplace_back(j, i);
+      pairs.emplace_back(i, RowId(j, i));
+    }
+  }
+  ShuffleArray(pairs);
+
+  BPlusTree tree(0, bpm, KP, 8, 8, false);
+  ASSERT_FALSE(tree.IsUnique());
+  for (auto &pair : pairs) {
+    ASSERT_TRUE(tree.Insert(make_key(pair.first), pair.second));
+  }
+  ASSERT_FALSE(tree.Insert(make_key(0), RowId(0, 0)));
+  ASSERT_FALSE(tree.Insert(make_key(1), RowId(0, 1)));
+  ASSERT_TRUE(tree.Check());
+  // one descent returns all rows of a key, in row id order
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> result;
+    ASSERT_TRUE(tree.GetValue(make_key(i), result));
+    ASSERT_EQ(rows[i], result);
+  }
+  // the iterator returns every row, in key then row id order
+  size_t scanned = 0;
+  int expected_key = 0;
+  size_t expected_row = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    if (expected_row == rows[expected_key].size()) {
+      expected_key++;
+      expected_row = 0;
+    }
+    ASSERT_EQ(rows[expected_key][expected_row].Get(), (*iter).second.Get());
+    expected_row++;
+    scanned++;
+  }
+  ASSERT_EQ(pairs.size(), scanned);
+  ASSERT_TRUE(tree.Check());
+
+  // remove every other row: keys with a single row go, posting lists shrink back into the leaf
+  ShuffleArray(pairs);
+  for (auto &pair : pairs) {
+    if (pair.second.GetPageId() % 2 == 0) {
+      ASSERT_TRUE(tree.Remove(make_key(pair.first), pair.second));
+    }
+  }
+  ASSERT_FALSE(tree.Remove(make_key(1), RowId(0, 1)));
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> expected;
+    for (auto &rid : rows[i]) {
+      if (rid.GetPageId() % 2 == 1) {
+        expected.push_back(rid);
+      }
+    }
+    std::vector<RowId> result;
+    ASSERT_EQ(!expected.empty(), tree.GetValue(make_key(i), result));
+    ASSERT_EQ(expected, result);
+  }
+  // removing a key drops all its rows
+  for (int i = 0; i < n; i += 50) {
+    tree.Remove(make_key(i));
+    std::vector<RowId> result;
+    ASSERT_FALSE(tree.GetValue(make_key(i), result));
+  }
+  ASSERT_TRUE(tree.Check());
+
+  // a bulk load groups the rows of a key
+  BPlusTree loaded(1, bpm, KP, UNDEFINED_SIZE, UNDEFINED_SIZE, false);
+  KeySorter sorter(KP, 64 * 1024);
+  for (auto &pair : pairs) {
+    sorter.Add(make_key(pair.first), pair.second);
+  }
+  sorter.Finish();
+  ASSERT_LT(1, sorter.GetRunCount());
+  ASSERT_EQ(static_cast<size_t>(n), sorter.CountKeys());
+  ASSERT_TRUE(loaded.BulkLoad(sorter));
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> result;
+    ASSERT_TRUE(loaded.GetValue(make_key(i), result));
+    ASSERT_EQ(rows[i], result);
+  }
+  ASSERT_TRUE(loaded.Insert(make_key(0), RowId(3 * PostingPage::MAX_SIZE, 0)));
+  ASSERT_TRUE(loaded.Remove(make_key(0), RowId(0, 0)));
+  ASSERT_TRUE(loaded.Check());
+
+  free(key);
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(BPlusTreeTests, ConcurrentInsertLookupTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr, 4);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 8);
+  auto make_key = [&](GenericKey *key, int i) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+  };
+  const int n = 40000;
+  const int num_writers = 4;
+  const int num_readers = 2;
+  // small pages so that splits and merges run into each other all the time
+  BPlusTree tree(0, bpm, KP, 8, 8);
+  std::atomic<bool> done{false};
+  std::atomic<int> wrong{0};
+  auto reader = [&](int seed, int low, int high, bool must_exist) {
+    std::mt19937 rng(seed);
+    GenericKey *key = KP.InitKey();
+    while (!done) {
+      int i = std::uniform_int_distribution<int>(low, high - 1)(rng);
+      make_key(key, i);
+      std::vector<RowId> result;
+      bool found = tree.GetValue(key, result);
+      if ((must_exist && !found) || (found && result[0].Get() != RowId(i, i).Get())) {
+        wrong++;
+      }
+    }
+    free(key);
+  };
+
+  // writers insert disjoint keys in random order while readers look up random keys
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back(reader, t, 0, n, false);
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t] {
+      std::vector<int> keys;
+      for (int i = t; i < n; i += num_writers) {
+        keys.push_back(i);
+      }
+      ShuffleArray(keys);
+      GenericKey *key = KP.InitKey();
+      for (int i : keys) {
+        make_key(key, i);
+        if (!tree.Insert(key, RowId(i, i))) {
+          wrong++;
+        }
+      }
+      free(key);
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, wrong);
+  ASSERT_TRUE(tree.Check());
+
+  // writers remove the even keys while readers look up odd keys, which must stay visible
+  done = false;
+  threads.clear();
+  writers.clear();
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      GenericKey *key = KP.InitKey();
+      while (!done) {
+        int i = std::uniform_int_distribution<int>(0, n / 2 - 1)(rng) * 2 + 1;
+        make_key(key, i);
+        std::vector<RowId> result;
+        if (!tree.GetValue(key, result) || result[0].Get() != RowId(i, i).Get()) {
+          wrong++;
+        }
+      }
+      free(key);
+    });
+  }
+  for (int t = 0; t < num_writers; t++) {
+    writers.emplace_back([&, t] {
+      GenericKey *key = KP.InitKey();
+      for (int i = t * 2; i < n; i += num_writers * 2) {
+        make_key(key, i);
+        tree.Remove(key);
+      }
+      free(key);
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, wrong);
+  ASSERT_TRUE(tree.Check());
+  GenericKey *key = KP.InitKey();
+  for (int i = 0; i < n; i++) {
+    make_key(key, i);
+    std::vector<RowId> result;
+    ASSERT_EQ(i % 2 == 1, tree.GetValue(key, result));
+  }
+  free(key);
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(BPlusTreeTests, ConcurrentThroughputBenchmark) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr, 4);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 8);
+  const int n = 100000;
+  // a mixed workload of 1 insert per 4 lookups, with 1 and with 4 threads on separate trees
+  for (int num_threads : {1, 4}) {
+    BPlusTree tree(num_threads, bpm, KP);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937 rng(t);
+        GenericKey *key = KP.InitKey();
+        for (int i = t; i < n; i += num_threads) {
+          std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+          KP.SerializeFromKey(key, Row(fields), table_schema);
+          tree.Insert(key, RowId(i, i));
+          for (int j = 0; j < 4; j++) {
+            std::vector<Field> lookup{Field(TypeId::kTypeInt, std::uniform_int_distribution<int>(0, i)(rng))};
+            KP.SerializeFromKey(key, Row(lookup), table_schema);
+            std::vector<RowId> result;
+            tree.GetValue(key, result);
+          }
+        }
+        free(key);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_threads << " thread(s): " << n * 5 / std::max<int64_t>(ms, 1) << " ops/ms" << std::endl;
+    ASSERT_TRUE(tree.Check());
+  }
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,207 @@
+#include "index/extendible_hash_index.h"
+
+#include <algorithm>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "storage/disk_manager.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+static void AllocateIndexRootsPage(BufferPoolManager *bpm) {
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_EQ(INDEX_ROOTS_PAGE_ID, page_id);
+  bpm->UnpinPage(CATALOG_META_PAGE_ID, false);
+  bpm->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+static std::vector<RowId> Lookup(Index *index, int key) {
+  std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+  std::vector<RowId> result;
+  index->ScanKey(Row(fields), result, nullptr);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+TEST(ExtendibleHashIndexTests, UniqueTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  auto *index = new ExtendibleHashIndex(0, &key_schema, 8, bpm);
+  const int n = 30000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i * 7 - n);
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(key, 1), nullptr));
+  }
+  // a bucket holds a few hundred keys, so the directory has split
+  ASSERT_GT(index->GetGlobalDepth(), 4);
+  for (int key : keys) {
+    ASSERT_EQ(std::vector<RowId>{RowId(key, 1)}, Lookup(index, key));
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    ASSERT_EQ(DB_FAILED, index->InsertEntry(Row(fields), RowId(key, 2), nullptr));
+  }
+  ASSERT_TRUE(Lookup(index, -n + 1).empty());
+
+  // the directory is found again through the index roots page
+  auto *reopened = new ExtendibleHashIndex(0, &key_schema, 8, bpm);
+  ASSERT_EQ(index->GetGlobalDepth(), reopened->GetGlobalDepth());
+  ASSERT_EQ(std::vector<RowId>{RowId(keys[0], 1)}, Lookup(reopened, keys[0]));
+  delete reopened;
+
+  // scans other than `=` read every bucket
+  std::vector<Field> bound{Field(TypeId::kTypeInt, 0)};
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(bound), result, nullptr, "<"));
+  ASSERT_EQ(static_cast<size_t>(std::count_if(keys.begin(), keys.end(), [](int key) { return key < 0; })),
+            result.size());
+  Field lower(TypeId::kTypeInt, 100);
+  Field upper(TypeId::kTypeInt, 200);
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanPrefix({}, &lower, false, &upper, true, result, nullptr));
+  ASSERT_EQ(static_cast<size_t>(std::count_if(keys.begin(), keys.end(), [](int key) { return key > 100 && key <= 200; })),
+            result.size());
+
+  // emptied buckets merge back and the directory shrinks
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(keys[i], 1), nullptr));
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index->RemoveEntry(Row(fields), RowId(keys[i], 1), nullptr));
+    if (i % 1000 == 0) {
+      for (size_t j = i + 1; j < keys.size(); j += 97) {
+        ASSERT_EQ(std::vector<RowId>{RowId(keys[j], 1)}, Lookup(index, keys[j]));
+      }
+    }
+  }
+  ASSERT_EQ(0, index->GetGlobalDepth());
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(ExtendibleHashIndexTests, NonUniqueTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, true, false)};
+  Schema key_schema(columns);
+  auto *index = new ExtendibleHashIndex(0, &key_schema, 8, bpm, false);
+  // a hot key with far more rows than a bucket holds goes to overflow pages instead of splitting the directory
+  std::vector<std::pair<int, RowId>> entries;
+  for (int i = 0; i < 5000; i++) {
+    entries.emplace_back(-42, RowId(i, 0));
+  }
+  for (int i = 0; i < 3000; i++) {
+    entries.emplace_back(i, RowId(100000 + i, 0));
+    entries.emplace_back(i, RowId(100000 + i, 1));
+  }
+  ShuffleArray(entries);
+  for (auto &entry : entries) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, entry.first)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), entry.second, nullptr));
+  }
+  ASSERT_LT(index->GetGlobalDepth(), HASH_DIRECTORY_MAX_DEPTH);
+  std::vector<Field> fields{Field(TypeId::kTypeInt, -42)};
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(Row(fields), RowId(7, 0), nullptr));
+  ASSERT_EQ(5000, Lookup(index, -42).size());
+  ASSERT_EQ((std::vector<RowId>{RowId(100007, 0), RowId(100007, 1)}), Lookup(index, 7));
+
+  // remove most rows of the hot key, the rest stay found
+  for (int i = 0; i < 5000; i++) {
+    if (i % 10 != 0) {
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(i, 0), nullptr));
+    }
+  }
+  std::vector<RowId> hot = Lookup(index, -42);
+  ASSERT_EQ(500, hot.size());
+  for (int i = 0; i < 5000; i += 10) {
+    ASSERT_TRUE(std::binary_search(hot.begin(), hot.end(), RowId(i, 0)));
+  }
+  for (int i = 0; i < 3000; i++) {
+    ASSERT_EQ(2, Lookup(index, i).size());
+  }
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  ASSERT_TRUE(Lookup(index, -42).empty());
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(ExtendibleHashIndexTests, HotKeyFirstTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, true, false)};
+  Schema key_schema(columns);
+  auto *index = new ExtendibleHashIndex(0, &key_schema, 8, bpm, false);
+  // the hot key fills the only bucket and grows a chain before any other key arrives
+  for (int i = 0; i < 2000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, -42)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  ASSERT_EQ(0, index->GetGlobalDepth());
+  // once other keys outnumber it, the chain splits again instead of taking every key of the index
+  for (int i = 0; i < 20000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(100000 + i, 0), nullptr));
+  }
+  ASSERT_GE(index->GetGlobalDepth(), 5);
+  ASSERT_EQ(2000, Lookup(index, -42).size());
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_EQ((std::vector<RowId>{RowId(100000 + i, 0)}), Lookup(index, i));
+  }
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(ExtendibleHashIndexTests, MultiPageDirectoryTest) {
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  AllocateIndexRootsPage(bpm);
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  auto *index = new ExtendibleHashIndex(0, &key_schema, 8, bpm);
+  // far more keys than buckets of a one page directory hold, the directory keeps doubling over more pages
+  const int n = 300000;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  ASSERT_GT(index->GetGlobalDepth(), HASH_DIRECTORY_PAGE_DEPTH);
+  auto *reopened = new ExtendibleHashIndex(0, &key_schema, 8, bpm);
+  ASSERT_EQ(index->GetGlobalDepth(), reopened->GetGlobalDepth());
+  delete reopened;
+  for (int i = 0; i < n; i += 7) {
+    ASSERT_EQ(std::vector<RowId>{RowId(i, 0)}, Lookup(index, i));
+  }
+
+  // emptied, the directory shrinks back into its first page
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  ASSERT_EQ(0, index->GetGlobalDepth());
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  delete index;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,65 @@
+#include "storage/row_id_bitmap.h"
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static std::vector<RowId> ToRowIds(const RowIdBitmap &bitmap) {
+  std::vector<RowId> rids;
+  for (auto &page : bitmap.GetPages()) {
+    std::vector<uint32_t> slots;
+    RowIdBitmap::CollectSlots(page.second, slots);
+    for (auto slot : slots) {
+      rids.emplace_back(page.first, slot);
+    }
+  }
+  return rids;
+}
+
+/**
+ * AND and OR random row id sets, pages sparse and dense, against std::set.
+ */
+TEST(RowIdBitmapTest, CombineTest) {
+  std::mt19937 rng(20231017);
+  for (int round = 0; round < 20; round++) {
+    RowIdBitmap bitmaps[2];
+    std::set<std::pair<page_id_t, uint32_t>> sets[2];
+    for (int i = 0; i < 2; i++) {
+      int count = rng() % 3000;
+      // a narrow slot range makes dense pages, a wide one pages of a few far apart slots
+      uint32_t max_slot = round % 2 == 0 ? 64 : 400;
+      for (int j = 0; j < count; j++) {
+        RowId rid(static_cast<page_id_t>(rng() % 50), static_cast<uint32_t>(rng() % max_slot));
+        bitmaps[i].Add(rid);
+        sets[i].emplace(rid.GetPageId(), rid.GetSlotNum());
+      }
+      ASSERT_EQ(sets[i].size(), bitmaps[i].Size());
+    }
+    RowIdBitmap intersection = bitmaps[0];
+    intersection.IntersectWith(bitmaps[1]);
+    RowIdBitmap union_bitmap = bitmaps[0];
+    union_bitmap.UnionWith(bitmaps[1]);
+    std::vector<RowId> expected_intersection, expected_union;
+    for (auto &rid : sets[0]) {
+      if (sets[1].count(rid) > 0) {
+        expected_intersection.emplace_back(rid.first, rid.second);
+      }
+    }
+    std::set<std::pair<page_id_t, uint32_t>> all(sets[0]);
+    all.insert(sets[1].begin(), sets[1].end());
+    for (auto &rid : all) {
+      expected_union.emplace_back(rid.first, rid.second);
+    }
+    ASSERT_EQ(expected_intersection.size(), intersection.Size());
+    ASSERT_EQ(expected_intersection, ToRowIds(intersection));
+    ASSERT_EQ(expected_union.size(), union_bitmap.Size());
+    ASSERT_EQ(expected_union, ToRowIds(union_bitmap));
+    for (auto &page : intersection.GetPages()) {
+      std::vector<uint32_t> slots;
+      RowIdBitmap::CollectSlots(page.second, slots);
+      ASSERT_FALSE(slots.empty());
+    }
+  }
+}
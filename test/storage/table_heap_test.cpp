@@ -1,5 +1,9 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -7,6 +11,7 @@
 #include "gtest/gtest.h"
 #include "record/field.h"
 #include "record/schema.h"
+#include "storage/row_id_bitmap.h"
 #include "utils/utils.h"
 
 static string db_file_name = "table_heap_test.db";
@@ -60,3 +65,433 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+/**
+ * Scan a table several times larger than the buffer pool and check that a page the scan never touches stays cached
+ * when the scan goes through a BufferRing, while a plain scan evicts it.
+ */
+TEST(TableHeapTest, RingScanTest) {
+  const std::string ring_db_file_name = "table_heap_ring_test.db";
+  const size_t buffer_pool_size = 32;
+  const int row_nums = 5000;
+  const char marker[] = "hot page";
+  remove(ring_db_file_name.c_str());
+  auto disk_mgr = new DiskManager(ring_db_file_name);
+  auto bpm = new BufferPoolManager(buffer_pool_size, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  page_id_t hot_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(hot_page_id));
+  ASSERT_TRUE(bpm->UnpinPage(hot_page_id, true));
+  ASSERT_TRUE(bpm->FlushPage(hot_page_id));
+
+  // the marker is never written back, it survives only as long as the page stays cached
+  auto scan_and_check_hot_page = [&](BufferRing *ring) {
+    Page *hot_page = bpm->FetchPage(hot_page_id);
+    memcpy(hot_page->GetData(), marker, sizeof(marker));
+    bpm->UnpinPage(hot_page_id, false);
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr, ring); iter != table_heap->End(); ++iter) {
+      EXPECT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    EXPECT_EQ(row_nums, count);
+    hot_page = bpm->FetchPage(hot_page_id);
+    bool cached = memcmp(hot_page->GetData(), marker, sizeof(marker)) == 0;
+    bpm->UnpinPage(hot_page_id, false);
+    return cached;
+  };
+  BufferRing ring(8);
+  EXPECT_TRUE(scan_and_check_hot_page(&ring));
+  EXPECT_FALSE(scan_and_check_hot_page(nullptr));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(ring_db_file_name.c_str());
+}
+
+/**
+ * A scan that cannot get a frame for its next page fails with an exception instead of dereferencing a null page.
+ */
+TEST(TableHeapTest, FullPoolScanTest) {
+  const std::string full_db_file_name = "table_heap_full_pool_test.db";
+  const size_t buffer_pool_size = 8;
+  remove(full_db_file_name.c_str());
+  auto disk_mgr = new DiskManager(full_db_file_name);
+  auto bpm = new BufferPoolManager(buffer_pool_size, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  for (int i = 0; i < 1000; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  auto iter = table_heap->Begin(nullptr);
+  // pin every frame, the table pages are all evicted
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (bpm->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  ASSERT_EQ(buffer_pool_size, pinned.size());
+  EXPECT_THROW(
+      {
+        while (iter != table_heap->End()) {
+          ++iter;
+        }
+      },
+      std::runtime_error);
+  for (auto id : pinned) {
+    bpm->UnpinPage(id, false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(full_db_file_name.c_str());
+}
+
+/**
+ * Scan a table that was written out completely, so every page comes from disk, with read-ahead and with read-ahead
+ * feeding a BufferRing.
+ */
+TEST(TableHeapTest, ReadAheadScanTest) {
+  const std::string read_ahead_db_file_name = "table_heap_read_ahead_test.db";
+  const size_t buffer_pool_size = 32;
+  const int row_nums = 5000;
+  remove(read_ahead_db_file_name.c_str());
+  // read-ahead batches go through io_uring where the kernel supports it
+  auto disk_mgr = new DiskManager(read_ahead_db_file_name, DEFAULT_IO_QUEUE_DEPTH);
+  auto bpm = new BufferPoolManager(buffer_pool_size, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  delete table_heap;
+  delete bpm;
+
+  for (bool use_ring : {false, true}) {
+    bpm = new BufferPoolManager(buffer_pool_size, disk_mgr);
+    table_heap = TableHeap::Create(bpm, first_page_id, schema.get(), nullptr, nullptr);
+    BufferRing ring(8);
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr, use_ring ? &ring : nullptr); iter != table_heap->End(); ++iter) {
+      EXPECT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    EXPECT_EQ(row_nums, count);
+    EXPECT_LT(0, bpm->GetPrefetchReadCount());
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete table_heap;
+    delete bpm;
+  }
+  delete disk_mgr;
+  remove(read_ahead_db_file_name.c_str());
+}
+
+/**
+ * Two tables growing at the same time must not interleave their pages: each new page should be allocated right behind
+ * the previous page of its own heap.
+ */
+TEST(TableHeapTest, InterleavedGrowthTest) {
+  const std::string growth_db_file_name = "table_heap_growth_test.db";
+  const int row_nums = 5000;
+  remove(growth_db_file_name.c_str());
+  auto disk_mgr = new DiskManager(growth_db_file_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heaps[2] = {TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr),
+                               TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr)};
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  for (int i = 0; i < row_nums; i++) {
+    for (auto table_heap : table_heaps) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+  }
+  for (auto table_heap : table_heaps) {
+    size_t num_pages = 0, num_jumps = 0;
+    page_id_t page_id = table_heap->GetFirstPageId();
+    while (page_id != INVALID_PAGE_ID) {
+      auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+      ASSERT_NE(nullptr, page);
+      page_id_t next_page_id = page->GetNextPageId();
+      bpm->UnpinPage(page_id, false);
+      if (next_page_id != INVALID_PAGE_ID && next_page_id != page_id + 1) {
+        num_jumps++;
+      }
+      num_pages++;
+      page_id = next_page_id;
+    }
+    // the chain may only jump between runs, the first page was allocated without a neighbour
+    EXPECT_LE(num_jumps, num_pages / EXTENT_RUN_SIZE + 1);
+    delete table_heap;
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_mgr;
+  remove(growth_db_file_name.c_str());
+}
+
+/**
+ * Collect random row ids of a table, some twice and some deleted, into a RowIdBitmap and read them back page by page.
+ * The rows must come out once each, in row id order.
+ */
+TEST(TableHeapTest, BitmapFetchTest) {
+  const std::string bitmap_db_file_name = "table_heap_bitmap_test.db";
+  const int row_nums = 5000;
+  remove(bitmap_db_file_name.c_str());
+  auto disk_mgr = new DiskManager(bitmap_db_file_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  std::mt19937 rng(20231017);
+  std::vector<int> picked;
+  for (int i = 0; i < row_nums; i++) {
+    if (rng() % 3 == 0) {
+      picked.push_back(i);
+    }
+  }
+  std::shuffle(picked.begin(), picked.end(), rng);
+  RowIdBitmap bitmap;
+  std::set<int> expected;
+  for (int i : picked) {
+    ASSERT_TRUE(bitmap.Add(rids[i]));
+    ASSERT_FALSE(bitmap.Add(rids[i]));
+    ASSERT_TRUE(bitmap.Contains(rids[i]));
+    // every tenth row is gone by the time the scan reads it
+    if (i % 10 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    } else {
+      expected.insert(i);
+    }
+  }
+  ASSERT_EQ(picked.size(), bitmap.Size());
+
+  std::vector<Row> rows;
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  for (auto &page : bitmap.GetPages()) {
+    ASSERT_TRUE(last_page_id == INVALID_PAGE_ID || last_page_id < page.first);
+    last_page_id = page.first;
+    std::vector<uint32_t> slots;
+    RowIdBitmap::CollectSlots(page.second, slots);
+    ASSERT_TRUE(table_heap->GetTuples(page.first, slots, rows, nullptr));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  ASSERT_EQ(expected.size(), rows.size());
+  auto iter = expected.begin();
+  for (size_t i = 0; i < rows.size(); i++, iter++) {
+    ASSERT_TRUE(i == 0 || rows[i - 1].GetRowId() < rows[i].GetRowId());
+    ASSERT_EQ(rids[*iter], rows[i].GetRowId());
+    ASSERT_EQ(CmpBool::kTrue, rows[i].GetField(0)->CompareEquals(Field(TypeId::kTypeInt, *iter)));
+  }
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(bitmap_db_file_name.c_str());
+}
+
+/**
+ * Insert latency into a table that lost half of its rows to random deletes. The inserts should land in the freed space
+ * instead of growing the table, also after the table is opened again.
+ */
+TEST(TableHeapTest, FragmentedInsertBenchmark) {
+  const std::string fsm_db_file_name = "table_heap_fsm_test.db";
+  const int row_nums = 20000;
+  remove(fsm_db_file_name.c_str());
+  auto disk_mgr = new DiskManager(fsm_db_file_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  auto insert_rows = [&](int count, std::vector<RowId> *rids) {
+    for (int i = 0; i < count; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      if (rids != nullptr) {
+        rids->push_back(row.GetRowId());
+      }
+    }
+  };
+  auto delete_rows = [&](std::vector<RowId> &rids, size_t count) {
+    std::shuffle(rids.begin(), rids.end(), std::mt19937(2024));
+    for (size_t i = 0; i < count; i++) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+    }
+    rids.erase(rids.begin(), rids.begin() + count);
+  };
+  auto count_pages = [&]() {
+    size_t num_pages = 0;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+      auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+      page_id_t next_page_id = page->GetNextPageId();
+      bpm->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    return num_pages;
+  };
+
+  std::vector<RowId> rids;
+  insert_rows(row_nums, &rids);
+  delete_rows(rids, row_nums / 2);
+  size_t num_pages = count_pages();
+  auto start = std::chrono::steady_clock::now();
+  insert_rows(row_nums / 2, &rids);
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "insert after 50% delete: us/row=" << elapsed.count() / (row_nums / 2) << " pages " << num_pages
+            << " -> " << count_pages() << std::endl;
+  EXPECT_LE(count_pages(), num_pages + num_pages / 50 + 1);
+
+  // an opened table rebuilds its free space map from the pages
+  delete_rows(rids, row_nums / 10);
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm, first_page_id, schema.get(), nullptr, nullptr);
+  num_pages = count_pages();
+  insert_rows(row_nums / 10, nullptr);
+  EXPECT_LE(count_pages(), num_pages + num_pages / 50 + 1);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(fsm_db_file_name.c_str());
+}
+
+/**
+ * Rows per second of loading a table row by row through InsertTuple and in batches through BulkInsert.
+ */
+TEST(TableHeapTest, BulkInsertBenchmark) {
+  const std::string bulk_db_file_name = "table_heap_bulk_test.db";
+  const int row_nums = 250000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  double rows_per_sec[2];
+  for (bool bulk : {false, true}) {
+    remove(bulk_db_file_name.c_str());
+    auto disk_mgr = new DiskManager(bulk_db_file_name);
+    auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+    TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+    // the rows are built up front, only the inserts are timed
+    std::vector<std::vector<Row>> batches;
+    for (int i = 0; i < row_nums; i++) {
+      if (i % BULK_INSERT_BATCH_SIZE == 0) {
+        batches.emplace_back();
+        batches.back().reserve(BULK_INSERT_BATCH_SIZE);
+      }
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+      batches.back().emplace_back(fields);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto &batch : batches) {
+      if (bulk) {
+        ASSERT_TRUE(table_heap->BulkInsert(batch, nullptr));
+        continue;
+      }
+      for (auto &row : batch) {
+        ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    rows_per_sec[bulk] = row_nums / elapsed.count();
+    std::cout << (bulk ? "BulkInsert" : "InsertTuple") << " rows/s=" << static_cast<uint64_t>(rows_per_sec[bulk])
+              << std::endl;
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+      count++;
+    }
+    EXPECT_EQ(row_nums, count);
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete table_heap;
+    delete bpm;
+    delete disk_mgr;
+  }
+  // one pin and one FSM update per page, and no slot search per row: at least 5x the rows per second
+  std::cout << "BulkInsert speedup=" << rows_per_sec[1] / rows_per_sec[0] << std::endl;
+  EXPECT_GE(rows_per_sec[1], 5 * rows_per_sec[0]);
+  remove(bulk_db_file_name.c_str());
+}
+
+/**
+ * A batch with a row too large for any page is rejected as a whole, the rows ahead of it are not left behind.
+ */
+TEST(TableHeapTest, BulkInsertRollbackTest) {
+  const std::string rollback_db_file_name = "table_heap_rollback_test.db";
+  remove(rollback_db_file_name.c_str());
+  auto disk_mgr = new DiskManager(rollback_db_file_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, PAGE_SIZE, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<char> characters(PAGE_SIZE, 'x');
+  std::vector<Row> rows;
+  for (int i = 0; i < 1000; i++) {
+    // row 900 does not fit a page
+    uint32_t length = i == 900 ? PAGE_SIZE : 64;
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters.data(), length, false)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_FALSE(table_heap->BulkInsert(rows, nullptr));
+  EXPECT_TRUE(table_heap->Begin(nullptr) == table_heap->End());
+  rows.erase(rows.begin() + 900);
+  ASSERT_TRUE(table_heap->BulkInsert(rows, nullptr));
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    int id = count < 900 ? count : count + 1;
+    EXPECT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+    count++;
+  }
+  EXPECT_EQ(999, count);
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(rollback_db_file_name.c_str());
+}